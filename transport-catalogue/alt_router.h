@@ -0,0 +1,175 @@
+#pragma once
+
+#include "astar_router.h"
+#include "dijkstra_router.h"
+#include "graph.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// Алгоритм ALT (A*, Landmarks, Triangle inequality): A* с нижними оценками
+// по заранее вычисленным расстояниям от нескольких опорных вершин (landmarks)
+// и до них. По неравенству треугольника для опорной вершины L
+//   d(v, to) >= d(L, to) - d(L, v)  и  d(v, to) >= d(v, L) - d(to, L),
+// эвристика - максимум этих оценок по всем опорным вершинам. В отличие от
+// оценки по координатам не зависит от того, насколько веса рёбер отличаются
+// от географических расстояний. Требует O(L * V) памяти.
+// Опорные вершины выбираются по одной: каждая следующая - самая далёкая
+// от уже выбранных (farthest-point selection).
+// Граф должен быть заморожен (DirectedWeightedGraph::Freeze)
+template <typename Weight>
+class AltRouter : public AStarRouter<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    AltRouter(const Graph& graph, size_t landmark_count);
+
+    // Новое ребро может сократить расстояния до опорных вершин,
+    // и оценки перестанут быть нижними. Расстояния вычисляются заново
+    bool Update(EdgeId /*first_new_edge*/) override {
+        return false;
+    }
+
+    const std::vector<VertexId>& GetLandmarks() const {
+        return landmarks_;
+    }
+
+private:
+    static constexpr Weight NO_WEIGHT = std::numeric_limits<Weight>::max();
+
+    // Расстояния от root до всех вершин (is_forward) или от всех вершин до root,
+    // NO_WEIGHT - пути нет
+    std::vector<Weight> ComputeDistances(VertexId root, bool is_forward) const;
+
+    void SelectLandmarks(size_t landmark_count);
+
+    Weight EstimateWeight(VertexId vertex, VertexId to) const;
+
+    const Graph& graph_;
+    std::vector<VertexId> landmarks_;
+    // Расстояния от опорных вершин и до них. Расстояния одной вершины
+    // до всех опорных хранятся подряд: [vertex * landmarks_.size() + landmark]
+    std::vector<Weight> from_landmarks_;
+    std::vector<Weight> to_landmarks_;
+};
+
+template <typename Weight>
+AltRouter<Weight>::AltRouter(const Graph& graph, size_t landmark_count)
+    : AStarRouter<Weight>(graph,
+        [this](VertexId vertex, VertexId to) {
+            return EstimateWeight(vertex, to);
+        })
+    , graph_(graph)
+{
+    if (landmark_count == 0) {
+        throw std::domain_error("Landmark count should be positive");
+    }
+    SelectLandmarks(landmark_count);
+}
+
+template <typename Weight>
+std::vector<Weight> AltRouter<Weight>::ComputeDistances(VertexId root, bool is_forward) const {
+    std::vector<Weight> distances(graph_.GetVertexCount(), NO_WEIGHT);
+    detail::SearchBuffers<Weight> buffers;
+    detail::RunDijkstra(graph_, buffers, root, is_forward,
+        [&distances](VertexId vertex, Weight weight, std::optional<EdgeId>) {
+            distances[vertex] = weight;
+            return detail::SettleAction::RELAX;
+        });
+    return distances;
+}
+
+template <typename Weight>
+void AltRouter<Weight>::SelectLandmarks(size_t landmark_count) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    landmark_count = std::min(landmark_count, vertex_count);
+    if (landmark_count == 0) {
+        return;
+    }
+
+    std::vector<std::vector<Weight>> from_distances;
+    std::vector<std::vector<Weight>> to_distances;
+    // Расстояние вершины до ближайшей выбранной опорной вершины, в сумме
+    // в обе стороны. NO_WEIGHT - вершина не связана ни с одной из них
+    std::vector<Weight> nearest(vertex_count, NO_WEIGHT);
+    // Первая опорная вершина - самая далёкая от вершины 0
+    std::vector<Weight> start_distances = ComputeDistances(0, true);
+    VertexId next = 0;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (start_distances[vertex] != NO_WEIGHT && start_distances[next] < start_distances[vertex]) {
+            next = vertex;
+        }
+    }
+
+    while (landmarks_.size() < landmark_count) {
+        landmarks_.push_back(next);
+        from_distances.push_back(ComputeDistances(next, true));
+        to_distances.push_back(ComputeDistances(next, false));
+        const auto& from_landmark = from_distances.back();
+        const auto& to_landmark = to_distances.back();
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            if (from_landmark[vertex] != NO_WEIGHT && to_landmark[vertex] != NO_WEIGHT) {
+                const Weight distance = from_landmark[vertex] + to_landmark[vertex];
+                if (nearest[vertex] == NO_WEIGHT || distance < nearest[vertex]) {
+                    nearest[vertex] = distance;
+                }
+            }
+        }
+        // Следующая - самая далёкая от выбранных. Вершины, не связанные
+        // ни с одной опорной, выбираются в первую очередь, чтобы оценки
+        // были и в других компонентах связности
+        next = landmarks_.front();
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            if (nearest[next] != NO_WEIGHT
+                && (nearest[vertex] == NO_WEIGHT || nearest[next] < nearest[vertex])) {
+                next = vertex;
+            }
+        }
+        if (nearest[next] == Weight{}) {
+            // Все вершины уже совпадают с опорными
+            break;
+        }
+    }
+
+    const size_t count = landmarks_.size();
+    from_landmarks_.resize(vertex_count * count);
+    to_landmarks_.resize(vertex_count * count);
+    for (size_t landmark = 0; landmark < count; ++landmark) {
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            from_landmarks_[vertex * count + landmark] = from_distances[landmark][vertex];
+            to_landmarks_[vertex * count + landmark] = to_distances[landmark][vertex];
+        }
+    }
+}
+
+template <typename Weight>
+Weight AltRouter<Weight>::EstimateWeight(VertexId vertex, VertexId to) const {
+    const size_t count = landmarks_.size();
+    const Weight* vertex_from = from_landmarks_.data() + vertex * count;
+    const Weight* vertex_to = to_landmarks_.data() + vertex * count;
+    const Weight* target_from = from_landmarks_.data() + to * count;
+    const Weight* target_to = to_landmarks_.data() + to * count;
+
+    // Разности считаются только для вершин, связанных с опорной,
+    // и только положительные, чтобы не переполнить беззнаковый вес
+    Weight estimate{};
+    for (size_t landmark = 0; landmark < count; ++landmark) {
+        if (vertex_from[landmark] != NO_WEIGHT && target_from[landmark] != NO_WEIGHT
+            && vertex_from[landmark] < target_from[landmark]) {
+            estimate = std::max<Weight>(estimate, target_from[landmark] - vertex_from[landmark]);
+        }
+        if (vertex_to[landmark] != NO_WEIGHT && target_to[landmark] != NO_WEIGHT
+            && target_to[landmark] < vertex_to[landmark]) {
+            estimate = std::max<Weight>(estimate, vertex_to[landmark] - target_to[landmark]);
+        }
+    }
+    return estimate;
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,283 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Поиск нескольких простых (без повторения вершин) путей алгоритмом Йена.
+// Сначала строится дерево кратчайших путей до конечной вершины обратным
+// поиском Дейкстры. Оно даёт первый путь, если его не передали, а расстояния
+// до конечной вершины служат точной нижней оценкой в поисках A* ответвлений
+// от найденных путей.
+// Граф должен быть заморожен
+template <typename Weight>
+class AlternativeRoutesFinder {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    explicit AlternativeRoutesFinder(const Graph& graph);
+
+    // Не более route_count путей из from в to в порядке возрастания веса
+    std::vector<RouteInfo> BuildRoutes(VertexId from, VertexId to, size_t route_count) const;
+
+    // То же с первым путём first_route - кратчайшим путём из from в to, который
+    // нашёл маршрутизатор. Из путей равного веса первым будет тот же, что
+    // и в ответе маршрутизатора на одиночный запрос
+    std::vector<RouteInfo> BuildRoutes(VertexId from, VertexId to, size_t route_count,
+                                       RouteInfo first_route) const;
+
+private:
+    using SearchBuffers = detail::SearchBuffers<Weight>;
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    struct Buffers {
+        // Расстояния до конечной вершины, prev_edges - первое ребро пути
+        SearchBuffers tree;
+        // Поиск ответвления, prev_edges - последнее ребро пути
+        SearchBuffers spur;
+        // Вершины начальной части пути, через которые ответвление идти не может
+        std::vector<bool> banned_vertices;
+    };
+
+    static Buffers& GetBuffers() {
+        thread_local Buffers buffers;
+        return buffers;
+    }
+
+    // Построить дерево кратчайших путей до вершины to
+    void BuildShortestPathTree(Buffers& buffers, VertexId to) const;
+
+    // Найти пути, следующие за first_route, по построенному дереву
+    std::vector<RouteInfo> BuildNextRoutes(Buffers& buffers, VertexId from, VertexId to,
+                                           size_t route_count, RouteInfo first_route) const;
+
+    // Кратчайший путь из spur в to, не проходящий через запрещённые вершины
+    // и не начинающийся с рёбер banned_edges
+    std::optional<RouteInfo> BuildSpurRoute(Buffers& buffers, VertexId spur, VertexId to,
+                                            const std::vector<EdgeId>& banned_edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+AlternativeRoutesFinder<Weight>::AlternativeRoutesFinder(const Graph& graph)
+    : graph_(graph)
+{
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Graph should be frozen");
+    }
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+void AlternativeRoutesFinder<Weight>::BuildShortestPathTree(Buffers& buffers, VertexId to) const {
+    SearchBuffers& tree = buffers.tree;
+    tree.Prepare(graph_.GetVertexCount());
+    Queue queue;
+    tree.Reach(to, ZERO_WEIGHT, std::nullopt);
+    queue.push({ZERO_WEIGHT, to});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (tree.weights[vertex] < weight) {
+            // Устаревший элемент очереди
+            continue;
+        }
+        for (const auto& arc : graph_.GetIncomingArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!tree.IsReached(arc.vertex) || candidate_weight < tree.weights[arc.vertex]) {
+                tree.Reach(arc.vertex, candidate_weight, arc.edge_id);
+                queue.push({candidate_weight, arc.vertex});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename AlternativeRoutesFinder<Weight>::RouteInfo>
+AlternativeRoutesFinder<Weight>::BuildSpurRoute(Buffers& buffers, VertexId spur, VertexId to,
+        const std::vector<EdgeId>& banned_edges) const {
+    const SearchBuffers& tree = buffers.tree;
+    SearchBuffers& search = buffers.spur;
+    search.Prepare(graph_.GetVertexCount());
+
+    // A* с оценкой по дереву кратчайших путей. Запреты только увеличивают
+    // расстояния, поэтому оценка допустима и монотонна
+    Queue queue;
+    search.Reach(spur, ZERO_WEIGHT, std::nullopt);
+    queue.push({tree.weights[spur], spur});
+    bool target_settled = false;
+    while (!queue.empty()) {
+        const auto [estimate, vertex] = queue.top();
+        queue.pop();
+        const Weight weight = search.weights[vertex];
+        if (weight + tree.weights[vertex] < estimate) {
+            // Устаревший элемент очереди
+            continue;
+        }
+        if (vertex == to) {
+            target_settled = true;
+            break;
+        }
+        for (const auto& arc : graph_.GetOutgoingArcs(vertex)) {
+            // Из вершины, откуда конечная недостижима, путь не продолжить
+            if (!tree.IsReached(arc.vertex) || buffers.banned_vertices[arc.vertex]) {
+                continue;
+            }
+            if (vertex == spur && std::find(banned_edges.begin(), banned_edges.end(),
+                                            arc.edge_id) != banned_edges.end()) {
+                continue;
+            }
+            const Weight candidate_weight = weight + arc.weight;
+            if (!search.IsReached(arc.vertex) || candidate_weight < search.weights[arc.vertex]) {
+                search.Reach(arc.vertex, candidate_weight, arc.edge_id);
+                queue.push({candidate_weight + tree.weights[arc.vertex], arc.vertex});
+            }
+        }
+    }
+
+    if (!target_settled) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = search.prev_edges[to];
+         edge_id;
+         edge_id = search.prev_edges[graph_.GetEdgeUnchecked(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return RouteInfo{search.weights[to], std::move(edges)};
+}
+
+template <typename Weight>
+std::vector<typename AlternativeRoutesFinder<Weight>::RouteInfo>
+AlternativeRoutesFinder<Weight>::BuildRoutes(VertexId from, VertexId to, size_t route_count) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    Buffers& buffers = GetBuffers();
+    BuildShortestPathTree(buffers, to);
+    if (route_count == 0 || !buffers.tree.IsReached(from)) {
+        return {};
+    }
+
+    // Первый путь - путь по дереву
+    RouteInfo first_route{buffers.tree.weights[from], {}};
+    for (std::optional<EdgeId> edge_id = buffers.tree.prev_edges[from];
+         edge_id;
+         edge_id = buffers.tree.prev_edges[graph_.GetEdgeUnchecked(*edge_id).to])
+    {
+        first_route.edges.push_back(*edge_id);
+    }
+    return BuildNextRoutes(buffers, from, to, route_count, std::move(first_route));
+}
+
+template <typename Weight>
+std::vector<typename AlternativeRoutesFinder<Weight>::RouteInfo>
+AlternativeRoutesFinder<Weight>::BuildRoutes(VertexId from, VertexId to, size_t route_count,
+                                             RouteInfo first_route) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    Buffers& buffers = GetBuffers();
+    BuildShortestPathTree(buffers, to);
+    if (route_count == 0 || !buffers.tree.IsReached(from)) {
+        return {};
+    }
+    return BuildNextRoutes(buffers, from, to, route_count, std::move(first_route));
+}
+
+template <typename Weight>
+std::vector<typename AlternativeRoutesFinder<Weight>::RouteInfo>
+AlternativeRoutesFinder<Weight>::BuildNextRoutes(Buffers& buffers, VertexId from, VertexId to,
+        size_t route_count, RouteInfo first_route) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<RouteInfo> routes;
+    routes.push_back(std::move(first_route));
+
+    buffers.banned_vertices.assign(vertex_count, false);
+    // Кандидаты упорядочены по весу, набор рёбер исключает повторы
+    std::set<std::pair<Weight, std::vector<EdgeId>>> candidates;
+    while (routes.size() < route_count) {
+        const size_t found_count = routes.size();
+        const RouteInfo& last_route = routes.back();
+        Weight root_weight = ZERO_WEIGHT;
+        VertexId spur = from;
+        // Ответвиться от последнего пути в каждой его вершине
+        for (size_t spur_index = 0; spur_index < last_route.edges.size(); ++spur_index) {
+            // Запретить продолжения, совпадающие с уже найденными путями
+            // с той же начальной частью
+            std::vector<EdgeId> banned_edges;
+            for (const RouteInfo& route : routes) {
+                if (route.edges.size() > spur_index
+                    && std::equal(last_route.edges.begin(),
+                                  last_route.edges.begin() + spur_index, route.edges.begin())) {
+                    banned_edges.push_back(route.edges[spur_index]);
+                }
+            }
+
+            if (auto spur_route = BuildSpurRoute(buffers, spur, to, banned_edges)) {
+                std::vector<EdgeId> edges(last_route.edges.begin(),
+                                          last_route.edges.begin() + spur_index);
+                edges.insert(edges.end(), spur_route->edges.begin(), spur_route->edges.end());
+                candidates.emplace(root_weight + spur_route->weight, std::move(edges));
+            }
+
+            // Сдвинуть начало ответвления на следующую вершину пути
+            const auto& edge = graph_.GetEdgeUnchecked(last_route.edges[spur_index]);
+            buffers.banned_vertices[spur] = true;
+            root_weight += edge.weight;
+            spur = edge.to;
+        }
+        for (const EdgeId edge_id : last_route.edges) {
+            buffers.banned_vertices[graph_.GetEdgeUnchecked(edge_id).from] = false;
+        }
+
+        // Лучший кандидат мог совпасть с уже найденным путём
+        while (!candidates.empty()) {
+            auto node = candidates.extract(candidates.begin());
+            auto& [weight, edges] = node.value();
+            bool is_new = std::none_of(routes.begin(), routes.end(),
+                [&edges = edges](const RouteInfo& route) {
+                    return route.edges == edges;
+                });
+            if (is_new) {
+                routes.push_back(RouteInfo{weight, std::move(edges)});
+                break;
+            }
+        }
+        if (routes.size() == found_count) {
+            // Других путей нет
+            break;
+        }
+    }
+    return routes;
+}
+
+}  // namespace graph
\ No newline at end of file
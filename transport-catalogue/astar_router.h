@@ -0,0 +1,141 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Поиск кратчайшего пути алгоритмом A*.
+// Эвристика heuristic(vertex, to) должна возвращать нижнюю оценку веса пути
+// от vertex до to, тогда найденный путь будет кратчайшим.
+// Граф должен быть заморожен (DirectedWeightedGraph::Freeze)
+template <typename Weight>
+class AStarRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+    using Heuristic = std::function<Weight(VertexId vertex, VertexId to)>;
+
+    AStarRouter(const Graph& graph, Heuristic heuristic);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Одним поиском Дейкстры из from: эвристика задаётся для одной конечной вершины
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override {
+        return detail::ComputeWeightsFromVertex(graph_, GetBuffers().search, from, targets);
+    }
+
+private:
+    using SearchBuffers = detail::SearchBuffers<Weight>;
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    struct AStarBuffers {
+        SearchBuffers search;
+        // Значение эвристики, вычисляется при первом достижении вершины
+        std::vector<Weight> potentials;
+    };
+
+    static AStarBuffers& GetBuffers() {
+        thread_local AStarBuffers buffers;
+        return buffers;
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    Heuristic heuristic_;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, Heuristic heuristic)
+    : graph_(graph)
+    , heuristic_(std::move(heuristic))
+{
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Graph should be frozen");
+    }
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo>
+AStarRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    AStarBuffers& buffers = GetBuffers();
+    SearchBuffers& search = buffers.search;
+    search.Prepare(vertex_count);
+    if (buffers.potentials.size() < vertex_count) {
+        buffers.potentials.resize(vertex_count);
+    }
+
+    // В очереди хранится оценка полного пути: пройденный вес + эвристика
+    Queue queue;
+    search.Reach(from, ZERO_WEIGHT, std::nullopt);
+    buffers.potentials[from] = heuristic_(from, to);
+    queue.push({buffers.potentials[from], from});
+
+    bool target_settled = false;
+    while (!queue.empty()) {
+        const auto [estimate, vertex] = queue.top();
+        queue.pop();
+        const Weight weight = search.weights[vertex];
+        if (weight + buffers.potentials[vertex] < estimate) {
+            // Устаревший элемент очереди
+            continue;
+        }
+        if (vertex == to) {
+            target_settled = true;
+            break;
+        }
+        for (const auto& arc : graph_.GetOutgoingArcs(vertex)) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!search.IsReached(arc.vertex)) {
+                buffers.potentials[arc.vertex] = heuristic_(arc.vertex, to);
+            } else if (!(candidate_weight < search.weights[arc.vertex])) {
+                continue;
+            }
+            // Вершина может быть обработана повторно, если эвристика
+            // допустима, но не монотонна
+            search.Reach(arc.vertex, candidate_weight, arc.edge_id);
+            queue.push({candidate_weight + buffers.potentials[arc.vertex], arc.vertex});
+        }
+    }
+
+    if (!target_settled) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = search.prev_edges[to];
+         edge_id;
+         edge_id = search.prev_edges[graph_.GetEdgeUnchecked(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{search.weights[to], std::move(edges)};
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Двунаправленный алгоритм Дейкстры: поиск ведётся одновременно
+// от начальной вершины по исходящим рёбрам и от конечной по входящим.
+// Поиск завершается, когда сумма минимумов обеих очередей
+// не меньше длины лучшего найденного пути.
+// Граф должен быть заморожен (DirectedWeightedGraph::Freeze)
+template <typename Weight>
+class BidirectionalDijkstraRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Одним поиском Дейкстры из from, встречный поиск не нужен
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override {
+        return detail::ComputeWeightsFromVertex(graph_, GetBuffers().forward, from, targets);
+    }
+
+private:
+    using SearchBuffers = detail::SearchBuffers<Weight>;
+    using Queue = detail::DijkstraQueue<Weight>;
+
+    struct BidirectionalBuffers {
+        // Расстояния от начальной вершины, prev_edges - последнее ребро пути
+        SearchBuffers forward;
+        // Расстояния до конечной вершины, prev_edges - первое ребро пути
+        SearchBuffers backward;
+    };
+
+    static BidirectionalBuffers& GetBuffers() {
+        thread_local BidirectionalBuffers buffers;
+        return buffers;
+    }
+
+    // Обработать одну вершину из очереди. is_forward задаёт направление поиска
+    void ProcessQueue(Queue& queue, SearchBuffers& current, const SearchBuffers& opposite,
+                      bool is_forward, std::optional<Weight>& best_weight,
+                      std::optional<VertexId>& meeting_vertex) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Graph should be frozen");
+    }
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+void BidirectionalDijkstraRouter<Weight>::ProcessQueue(Queue& queue, SearchBuffers& current,
+        const SearchBuffers& opposite, bool is_forward, std::optional<Weight>& best_weight,
+        std::optional<VertexId>& meeting_vertex) const {
+    const auto [weight, vertex] = queue.top();
+    queue.pop();
+    if (current.weights[vertex] < weight) {
+        // Устаревший элемент очереди
+        return;
+    }
+    const auto arcs = is_forward ? graph_.GetOutgoingArcs(vertex)
+                                 : graph_.GetIncomingArcs(vertex);
+    for (const auto& arc : arcs) {
+        const VertexId next = arc.vertex;
+        const Weight candidate_weight = weight + arc.weight;
+        if (!current.IsReached(next) || candidate_weight < current.weights[next]) {
+            current.Reach(next, candidate_weight, arc.edge_id);
+            queue.push({candidate_weight, next});
+            // Проверить, не нашёлся ли путь короче через эту вершину
+            if (opposite.IsReached(next)) {
+                const Weight path_weight = candidate_weight + opposite.weights[next];
+                if (!best_weight || path_weight < *best_weight) {
+                    best_weight = path_weight;
+                    meeting_vertex = next;
+                }
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo>
+BidirectionalDijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ZERO_WEIGHT, {}};
+    }
+
+    BidirectionalBuffers& buffers = GetBuffers();
+    SearchBuffers& forward = buffers.forward;
+    SearchBuffers& backward = buffers.backward;
+    forward.Prepare(vertex_count);
+    backward.Prepare(vertex_count);
+
+    Queue forward_queue;
+    Queue backward_queue;
+    forward.Reach(from, ZERO_WEIGHT, std::nullopt);
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward.Reach(to, ZERO_WEIGHT, std::nullopt);
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    std::optional<VertexId> meeting_vertex;
+    while (!forward_queue.empty() && !backward_queue.empty()) {
+        if (best_weight
+            && !(forward_queue.top().first + backward_queue.top().first < *best_weight)) {
+            break;
+        }
+        // Продвигать направление с меньшей очередью
+        if (forward_queue.size() <= backward_queue.size()) {
+            ProcessQueue(forward_queue, forward, backward, true, best_weight, meeting_vertex);
+        } else {
+            ProcessQueue(backward_queue, backward, forward, false, best_weight, meeting_vertex);
+        }
+    }
+
+    if (!meeting_vertex) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = forward.prev_edges[*meeting_vertex];
+         edge_id;
+         edge_id = forward.prev_edges[graph_.GetEdgeUnchecked(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (std::optional<EdgeId> edge_id = backward.prev_edges[*meeting_vertex];
+         edge_id;
+         edge_id = backward.prev_edges[graph_.GetEdgeUnchecked(*edge_id).to])
+    {
+        edges.push_back(*edge_id);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define GRAPH_FLOYD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+namespace detail {
+
+// Улучшить count маршрутов строки row через вершину, до которой из начала
+// строки путь весом through_weight, а из неё - пути through_row.
+// Последнее ребро улучшенного пути - последнее ребро пути из through_row
+template <typename Weight>
+void RelaxRowThrough(Weight through_weight, const Weight* through_row,
+                     const EdgeId* through_prev, Weight* row, EdgeId* prev, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const Weight candidate_weight = through_weight + through_row[i];
+        if (candidate_weight < row[i]) {
+            row[i] = candidate_weight;
+            prev[i] = through_prev[i];
+        }
+    }
+}
+
+#ifdef GRAPH_FLOYD_AVX2
+inline bool HasAvx2() {
+    return __builtin_cpu_supports("avx2");
+}
+
+// То же для double по 4 элемента. Номер ребра занимает 64 бита,
+// как и вес, поэтому оба массива обновляются по одной маске
+__attribute__((target("avx2")))
+inline void RelaxRowThroughAvx2(double through_weight, const double* through_row,
+                                const EdgeId* through_prev, double* row, EdgeId* prev,
+                                size_t count) {
+    static_assert(sizeof(EdgeId) == sizeof(double));
+    const __m256d through = _mm256_set1_pd(through_weight);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d candidate = _mm256_add_pd(through, _mm256_loadu_pd(through_row + i));
+        const __m256d current = _mm256_loadu_pd(row + i);
+        const __m256d mask = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        if (_mm256_movemask_pd(mask) == 0) {
+            continue;
+        }
+        _mm256_storeu_pd(row + i, _mm256_blendv_pd(current, candidate, mask));
+        const __m256d current_prev = _mm256_castsi256_pd(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev + i)));
+        const __m256d candidate_prev = _mm256_castsi256_pd(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through_prev + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev + i),
+            _mm256_castpd_si256(_mm256_blendv_pd(current_prev, candidate_prev, mask)));
+    }
+    RelaxRowThrough(through_weight, through_row + i, through_prev + i, row + i, prev + i,
+                    count - i);
+}
+#else
+inline bool HasAvx2() {
+    return false;
+}
+#endif
+
+}  // namespace detail
+
+// Предварительный расчёт всех маршрутов блочным алгоритмом Флойда-Уоршелла.
+// Веса и последние рёбра путей хранятся в двух плоских матрицах, строки
+// дополнены до размера, кратного TILE_SIZE. Отсутствие маршрута обозначается
+// весом NO_ROUTE, сумма с которым не меньше веса любого маршрута, поэтому
+// внутренний цикл не ветвится.
+// Матрица обрабатывается блоками TILE_SIZE x TILE_SIZE, которые помещаются
+// в кэш процессора. На каждом шаге сначала считается диагональный блок,
+// затем блоки его строки и столбца, затем остальные. Блоки второго и третьего
+// этапов не зависят друг от друга и обрабатываются в thread_count потоках.
+// Для весов double внутренний цикл использует AVX2, если процессор его поддерживает
+template <typename Weight>
+class BlockedFloydRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    // При thread_count == 0 число потоков равно числу ядер процессора
+    explicit BlockedFloydRouter(const Graph& graph, size_t thread_count = 0);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Дополнить матрицы новыми вершинами и улучшить маршруты через новые рёбра
+    bool Update(EdgeId first_new_edge) override;
+
+private:
+    static constexpr size_t TILE_SIZE = 64;
+    // Для целых весов половина максимума, чтобы сумма двух NO_ROUTE не переполнялась
+    static constexpr Weight NO_ROUTE = std::numeric_limits<Weight>::has_infinity
+        ? std::numeric_limits<Weight>::infinity()
+        : std::numeric_limits<Weight>::max() / 2;
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    static size_t ComputeStride(size_t vertex_count) {
+        return (vertex_count + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+    }
+
+    void CheckWeight(Weight weight) const {
+        if (weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        if (!(weight < NO_ROUTE)) {
+            throw std::overflow_error("Edge weight is too large for routes table");
+        }
+    }
+
+    void RelaxRow(Weight through_weight, VertexId through, VertexId from, size_t first_column,
+                  size_t count) {
+        const size_t through_offset = through * stride_ + first_column;
+        const size_t from_offset = from * stride_ + first_column;
+#ifdef GRAPH_FLOYD_AVX2
+        if constexpr (std::is_same_v<Weight, double>) {
+            if (use_avx2_) {
+                detail::RelaxRowThroughAvx2(through_weight, &weights_[through_offset],
+                    &prev_edges_[through_offset], &weights_[from_offset],
+                    &prev_edges_[from_offset], count);
+                return;
+            }
+        }
+#endif
+        detail::RelaxRowThrough(through_weight, &weights_[through_offset],
+            &prev_edges_[through_offset], &weights_[from_offset], &prev_edges_[from_offset],
+            count);
+    }
+
+    // Улучшить маршруты блока (row_tile, column_tile) через вершины блока through_tile
+    void RelaxTile(size_t row_tile, size_t column_tile, size_t through_tile) {
+        for (VertexId through = through_tile * TILE_SIZE;
+             through < (through_tile + 1) * TILE_SIZE; ++through) {
+            for (VertexId from = row_tile * TILE_SIZE; from < (row_tile + 1) * TILE_SIZE; ++from) {
+                const Weight through_weight = weights_[from * stride_ + through];
+                if (through_weight == NO_ROUTE) {
+                    continue;
+                }
+                RelaxRow(through_weight, through, from, column_tile * TILE_SIZE, TILE_SIZE);
+            }
+        }
+    }
+
+    // Обработать блоки tiles в thread_count_ потоках
+    void RelaxTiles(const std::vector<std::pair<size_t, size_t>>& tiles, size_t through_tile);
+
+    void InitializeRoutes();
+
+    // Улучшить маршруты, которые становятся короче при проезде по ребру edge_id
+    void RelaxRoutesThroughEdge(EdgeId edge_id);
+
+    const Graph& graph_;
+    size_t thread_count_;
+    bool use_avx2_;
+    size_t vertex_count_;
+    // Размер строки матриц
+    size_t stride_;
+    std::vector<Weight> weights_;
+    std::vector<EdgeId> prev_edges_;
+};
+
+template <typename Weight>
+BlockedFloydRouter<Weight>::BlockedFloydRouter(const Graph& graph, size_t thread_count)
+    : graph_(graph)
+    , thread_count_(thread_count > 0 ? thread_count
+                                     : std::max(1u, std::thread::hardware_concurrency()))
+    , use_avx2_(detail::HasAvx2())
+    , vertex_count_(graph.GetVertexCount())
+    , stride_(ComputeStride(vertex_count_))
+    , weights_(stride_ * stride_, NO_ROUTE)
+    , prev_edges_(stride_ * stride_, NO_EDGE)
+{
+    InitializeRoutes();
+
+    const size_t tile_count = stride_ / TILE_SIZE;
+    std::vector<std::pair<size_t, size_t>> tiles;
+    for (size_t through_tile = 0; through_tile < tile_count; ++through_tile) {
+        RelaxTile(through_tile, through_tile, through_tile);
+
+        tiles.clear();
+        for (size_t tile = 0; tile < tile_count; ++tile) {
+            if (tile != through_tile) {
+                tiles.emplace_back(through_tile, tile);
+                tiles.emplace_back(tile, through_tile);
+            }
+        }
+        RelaxTiles(tiles, through_tile);
+
+        tiles.clear();
+        for (size_t row_tile = 0; row_tile < tile_count; ++row_tile) {
+            for (size_t column_tile = 0; column_tile < tile_count; ++column_tile) {
+                if (row_tile != through_tile && column_tile != through_tile) {
+                    tiles.emplace_back(row_tile, column_tile);
+                }
+            }
+        }
+        RelaxTiles(tiles, through_tile);
+    }
+}
+
+template <typename Weight>
+void BlockedFloydRouter<Weight>::InitializeRoutes() {
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        weights_[vertex * stride_ + vertex] = Weight{};
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            CheckWeight(edge.weight);
+            const size_t offset = vertex * stride_ + edge.to;
+            if (edge.weight < weights_[offset]) {
+                weights_[offset] = edge.weight;
+                prev_edges_[offset] = edge_id;
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void BlockedFloydRouter<Weight>::RelaxTiles(const std::vector<std::pair<size_t, size_t>>& tiles,
+                                            size_t through_tile) {
+    const size_t thread_count = std::min(thread_count_, tiles.size());
+    if (thread_count <= 1) {
+        for (const auto& [row_tile, column_tile] : tiles) {
+            RelaxTile(row_tile, column_tile, through_tile);
+        }
+        return;
+    }
+    // Потоки разбирают блоки по одному, записываемые блоки не пересекаются
+    std::atomic<size_t> next_tile{0};
+    auto worker = [this, &tiles, &next_tile, through_tile] {
+        for (size_t i = next_tile++; i < tiles.size(); i = next_tile++) {
+            RelaxTile(tiles[i].first, tiles[i].second, through_tile);
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+template <typename Weight>
+void BlockedFloydRouter<Weight>::RelaxRoutesThroughEdge(EdgeId edge_id) {
+    const auto& edge = graph_.GetEdgeUnchecked(edge_id);
+    CheckWeight(edge.weight);
+    for (VertexId from = 0; from < vertex_count_; ++from) {
+        const Weight route_weight = weights_[from * stride_ + edge.from];
+        if (route_weight == NO_ROUTE) {
+            continue;
+        }
+        const Weight weight_through = route_weight + edge.weight;
+        // Если ребро не сокращает путь до своего конца, строка не изменится
+        const size_t offset_to = from * stride_ + edge.to;
+        if (!(weight_through < weights_[offset_to])) {
+            continue;
+        }
+        weights_[offset_to] = weight_through;
+        prev_edges_[offset_to] = edge_id;
+        RelaxRow(weight_through, edge.to, from, 0, vertex_count_);
+    }
+}
+
+template <typename Weight>
+bool BlockedFloydRouter<Weight>::Update(EdgeId first_new_edge) {
+    const size_t old_vertex_count = vertex_count_;
+    const size_t old_stride = stride_;
+    vertex_count_ = graph_.GetVertexCount();
+    stride_ = ComputeStride(vertex_count_);
+
+    // Переложить строки в матрицы нового размера
+    if (stride_ != old_stride) {
+        std::vector<Weight> weights(stride_ * stride_, NO_ROUTE);
+        std::vector<EdgeId> prev_edges(stride_ * stride_, NO_EDGE);
+        for (VertexId from = 0; from < old_vertex_count; ++from) {
+            std::copy_n(&weights_[from * old_stride], old_vertex_count, &weights[from * stride_]);
+            std::copy_n(&prev_edges_[from * old_stride], old_vertex_count,
+                        &prev_edges[from * stride_]);
+        }
+        weights_ = std::move(weights);
+        prev_edges_ = std::move(prev_edges);
+    }
+    for (VertexId vertex = old_vertex_count; vertex < vertex_count_; ++vertex) {
+        weights_[vertex * stride_ + vertex] = Weight{};
+    }
+
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (EdgeId edge_id = first_new_edge; edge_id < edge_count; ++edge_id) {
+        RelaxRoutesThroughEdge(edge_id);
+    }
+    return true;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> BlockedFloydRouter<Weight>::ComputeWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    if (from >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const Weight weight = weights_[from * stride_ + to];
+        weights.push_back(weight == NO_ROUTE ? std::nullopt : std::optional<Weight>(weight));
+    }
+    return weights;
+}
+
+template <typename Weight>
+std::optional<typename BlockedFloydRouter<Weight>::RouteInfo>
+BlockedFloydRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Weight weight = weights_[from * stride_ + to];
+    if (weight == NO_ROUTE) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edges_[from * stride_ + to];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges_[from * stride_ + graph_.GetEdgeUnchecked(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,447 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Поиск кратчайшего пути с помощью иерархии сжатий (Contraction Hierarchies).
+// При построении вершины по очереди удаляются из графа, а пути через
+// удалённую вершину заменяются рёбрами-сокращениями. Запрос выполняется
+// двунаправленным поиском только по рёбрам, ведущим к вершинам с большим рангом.
+// Сокращения в ответе раскрываются обратно в рёбра исходного графа
+template <typename Weight>
+class ContractionHierarchyRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit ContractionHierarchyRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Новое ребро может изменить порядок сжатия, иерархия строится заново
+    bool Update(EdgeId /*first_new_edge*/) override {
+        return false;
+    }
+
+    // Количество добавленных рёбер-сокращений
+    size_t GetShortcutCount() const {
+        return shortcut_parts_.size();
+    }
+
+private:
+    // Ребро иерархии. Первые GetEdgeCount() рёбер совпадают с рёбрами графа,
+    // остальные являются сокращениями
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+    };
+
+    using SearchBuffers = detail::SearchBuffers<Weight>;
+    using QueueItem = std::pair<Weight, VertexId>;
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+    struct BidirectionalBuffers {
+        SearchBuffers forward;
+        SearchBuffers backward;
+    };
+
+    static BidirectionalBuffers& GetBuffers() {
+        thread_local BidirectionalBuffers buffers;
+        return buffers;
+    }
+
+    // Вспомогательные данные, нужные только во время построения иерархии
+    struct Preprocessing {
+        std::vector<std::vector<EdgeId>> out_edges;
+        std::vector<std::vector<EdgeId>> in_edges;
+        std::vector<bool> contracted;
+        std::vector<int> contracted_neighbors;
+        // Глубина вершины в иерархии
+        std::vector<int> levels;
+        SearchBuffers witness_buffers;
+    };
+
+    // Результат пробного сжатия вершины
+    struct Contraction {
+        std::vector<EdgeId> in_edges;
+        std::vector<EdgeId> out_edges;
+        // Пары входящее - исходящее ребро, для которых нужны сокращения
+        std::vector<std::pair<EdgeId, EdgeId>> shortcuts;
+    };
+
+    // Ограничение на число вершин, обрабатываемых при поиске свидетеля.
+    // Если свидетель не найден, сокращение добавляется, что не нарушает
+    // корректность, а только увеличивает размер иерархии
+    static constexpr int WITNESS_SETTLED_LIMIT = 50;
+
+    // Оставить в списке рёбер только рёбра к несжатым вершинам,
+    // по одному минимальному ребру на каждую соседнюю вершину
+    std::vector<EdgeId> CollectNeighborEdges(Preprocessing& data, VertexId vertex,
+                                             bool is_out) const;
+
+    // Найти пути из from в обход vertex весом не больше limit.
+    // Результат остаётся в data.witness_buffers. Любая найденная метка - вес
+    // реального пути, поэтому прерванный поиск тоже даёт верные свидетели
+    void SearchWitnesses(Preprocessing& data, VertexId from, VertexId vertex,
+                         Weight limit) const;
+
+    // Определить, какие сокращения потребуются при сжатии вершины
+    Contraction SimulateContraction(Preprocessing& data, VertexId vertex) const;
+
+    int ComputePriority(const Preprocessing& data, VertexId vertex,
+                        const Contraction& contraction) const;
+
+    // Сжать вершину, добавив найденные сокращения
+    void ApplyContraction(Preprocessing& data, VertexId vertex, const Contraction& contraction);
+
+    void BuildHierarchy();
+
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+    std::vector<HierarchyEdge> edges_;
+    // Пары рёбер, которые заменяет сокращение с номером GetEdgeCount() + i
+    std::vector<std::pair<EdgeId, EdgeId>> shortcut_parts_;
+    // Ранг вершины - порядковый номер её сжатия
+    std::vector<size_t> ranks_;
+    // Рёбра к вершинам с большим рангом
+    std::vector<std::vector<EdgeId>> upward_edges_;
+    // Рёбра из вершин с большим рангом, для обратного поиска
+    std::vector<std::vector<EdgeId>> downward_edges_;
+};
+
+template <typename Weight>
+ContractionHierarchyRouter<Weight>::ContractionHierarchyRouter(const Graph& graph)
+    : graph_(graph)
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    edges_.reserve(edge_count);
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        edges_.push_back({edge.from, edge.to, edge.weight});
+    }
+    BuildHierarchy();
+}
+
+template <typename Weight>
+std::vector<EdgeId> ContractionHierarchyRouter<Weight>::CollectNeighborEdges(
+        Preprocessing& data, VertexId vertex, bool is_out) const {
+    std::vector<EdgeId>& edge_list = is_out ? data.out_edges[vertex] : data.in_edges[vertex];
+    auto neighbor = [this, is_out](EdgeId edge_id) {
+        return is_out ? edges_[edge_id].to : edges_[edge_id].from;
+    };
+    // Удалить рёбра к уже сжатым вершинам и петли
+    edge_list.erase(std::remove_if(edge_list.begin(), edge_list.end(),
+        [&](EdgeId edge_id) {
+            const VertexId other = neighbor(edge_id);
+            return other == vertex || data.contracted[other];
+        }), edge_list.end());
+
+    std::vector<EdgeId> result = edge_list;
+    std::sort(result.begin(), result.end(), [&](EdgeId lhs, EdgeId rhs) {
+        if (neighbor(lhs) != neighbor(rhs)) {
+            return neighbor(lhs) < neighbor(rhs);
+        }
+        if (edges_[lhs].weight != edges_[rhs].weight) {
+            return edges_[lhs].weight < edges_[rhs].weight;
+        }
+        return lhs < rhs;
+    });
+    result.erase(std::unique(result.begin(), result.end(), [&](EdgeId lhs, EdgeId rhs) {
+        return neighbor(lhs) == neighbor(rhs);
+    }), result.end());
+    return result;
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::SearchWitnesses(Preprocessing& data, VertexId from,
+        VertexId vertex, Weight limit) const {
+    SearchBuffers& buffers = data.witness_buffers;
+    buffers.Prepare(graph_.GetVertexCount());
+
+    Queue queue;
+    buffers.Reach(from, ZERO_WEIGHT, std::nullopt);
+    queue.push({ZERO_WEIGHT, from});
+    int settled = 0;
+    while (!queue.empty() && settled < WITNESS_SETTLED_LIMIT) {
+        const auto [weight, current] = queue.top();
+        queue.pop();
+        if (buffers.weights[current] < weight) {
+            continue;
+        }
+        ++settled;
+        for (const EdgeId edge_id : data.out_edges[current]) {
+            const auto& edge = edges_[edge_id];
+            if (edge.to == vertex || data.contracted[edge.to]) {
+                continue;
+            }
+            const Weight candidate_weight = weight + edge.weight;
+            if (limit < candidate_weight) {
+                continue;
+            }
+            if (!buffers.IsReached(edge.to) || candidate_weight < buffers.weights[edge.to]) {
+                buffers.Reach(edge.to, candidate_weight, edge_id);
+                queue.push({candidate_weight, edge.to});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+typename ContractionHierarchyRouter<Weight>::Contraction
+ContractionHierarchyRouter<Weight>::SimulateContraction(Preprocessing& data,
+                                                        VertexId vertex) const {
+    Contraction contraction;
+    contraction.in_edges = CollectNeighborEdges(data, vertex, false);
+    contraction.out_edges = CollectNeighborEdges(data, vertex, true);
+    if (contraction.out_edges.empty()) {
+        return contraction;
+    }
+
+    Weight max_out_weight = ZERO_WEIGHT;
+    for (const EdgeId out_edge_id : contraction.out_edges) {
+        max_out_weight = std::max(max_out_weight, edges_[out_edge_id].weight);
+    }
+
+    for (const EdgeId in_edge_id : contraction.in_edges) {
+        const VertexId from = edges_[in_edge_id].from;
+        // Один поиск свидетелей на все исходящие рёбра вершины
+        SearchWitnesses(data, from, vertex, edges_[in_edge_id].weight + max_out_weight);
+        const SearchBuffers& witnesses = data.witness_buffers;
+        for (const EdgeId out_edge_id : contraction.out_edges) {
+            const VertexId to = edges_[out_edge_id].to;
+            if (from == to) {
+                continue;
+            }
+            const Weight weight = edges_[in_edge_id].weight + edges_[out_edge_id].weight;
+            if (witnesses.IsReached(to) && !(weight < witnesses.weights[to])) {
+                continue;
+            }
+            contraction.shortcuts.push_back({in_edge_id, out_edge_id});
+        }
+    }
+    return contraction;
+}
+
+template <typename Weight>
+int ContractionHierarchyRouter<Weight>::ComputePriority(const Preprocessing& data,
+        VertexId vertex, const Contraction& contraction) const {
+    // Разность рёбер плюс число уже сжатых соседей и глубина вершины в иерархии,
+    // чтобы сжатие распределялось по графу равномерно
+    const int edge_difference = static_cast<int>(contraction.shortcuts.size())
+        - static_cast<int>(contraction.in_edges.size() + contraction.out_edges.size());
+    return edge_difference + data.contracted_neighbors[vertex] + data.levels[vertex];
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::ApplyContraction(Preprocessing& data, VertexId vertex,
+                                                          const Contraction& contraction) {
+    for (const auto& [in_edge_id, out_edge_id] : contraction.shortcuts) {
+        const VertexId from = edges_[in_edge_id].from;
+        const VertexId to = edges_[out_edge_id].to;
+        const EdgeId shortcut_id = edges_.size();
+        edges_.push_back({from, to, edges_[in_edge_id].weight + edges_[out_edge_id].weight});
+        shortcut_parts_.push_back({in_edge_id, out_edge_id});
+        data.out_edges[from].push_back(shortcut_id);
+        data.in_edges[to].push_back(shortcut_id);
+    }
+
+    data.contracted[vertex] = true;
+    auto update_neighbor = [&data, vertex](VertexId neighbor) {
+        ++data.contracted_neighbors[neighbor];
+        data.levels[neighbor] = std::max(data.levels[neighbor], data.levels[vertex] + 1);
+    };
+    for (const EdgeId edge_id : contraction.in_edges) {
+        update_neighbor(edges_[edge_id].from);
+    }
+    for (const EdgeId edge_id : contraction.out_edges) {
+        update_neighbor(edges_[edge_id].to);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::BuildHierarchy() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    ranks_.assign(vertex_count, 0);
+
+    Preprocessing data;
+    data.out_edges.resize(vertex_count);
+    data.in_edges.resize(vertex_count);
+    data.contracted.assign(vertex_count, false);
+    data.contracted_neighbors.assign(vertex_count, 0);
+    data.levels.assign(vertex_count, 0);
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        data.out_edges[edges_[edge_id].from].push_back(edge_id);
+        data.in_edges[edges_[edge_id].to].push_back(edge_id);
+    }
+
+    // Очередь вершин по приоритету с ленивым обновлением:
+    // приоритет извлечённой вершины пересчитывается перед сжатием
+    using PriorityItem = std::pair<int, VertexId>;
+    std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.push({ComputePriority(data, vertex, SimulateContraction(data, vertex)), vertex});
+    }
+
+    size_t rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        const Contraction contraction = SimulateContraction(data, vertex);
+        const int priority = ComputePriority(data, vertex, contraction);
+        if (!queue.empty() && queue.top().first < priority) {
+            queue.push({priority, vertex});
+            continue;
+        }
+        ApplyContraction(data, vertex, contraction);
+        ranks_[vertex] = rank++;
+    }
+
+    upward_edges_.assign(vertex_count, {});
+    downward_edges_.assign(vertex_count, {});
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const HierarchyEdge& edge = edges_[edge_id];
+        if (edge.from == edge.to) {
+            continue;
+        }
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            upward_edges_[edge.from].push_back(edge_id);
+        } else {
+            downward_edges_[edge.to].push_back(edge_id);
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchyRouter<Weight>::UnpackEdge(EdgeId edge_id,
+                                                   std::vector<EdgeId>& edges) const {
+    const size_t original_edge_count = graph_.GetEdgeCount();
+    std::vector<EdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+        if (current < original_edge_count) {
+            edges.push_back(current);
+        } else {
+            const auto& [first, second] = shortcut_parts_[current - original_edge_count];
+            stack.push_back(second);
+            stack.push_back(first);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchyRouter<Weight>::RouteInfo>
+ContractionHierarchyRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    BidirectionalBuffers& buffers = GetBuffers();
+    SearchBuffers& forward = buffers.forward;
+    SearchBuffers& backward = buffers.backward;
+    forward.Prepare(vertex_count);
+    backward.Prepare(vertex_count);
+
+    Queue forward_queue;
+    Queue backward_queue;
+    forward.Reach(from, ZERO_WEIGHT, std::nullopt);
+    forward_queue.push({ZERO_WEIGHT, from});
+    backward.Reach(to, ZERO_WEIGHT, std::nullopt);
+    backward_queue.push({ZERO_WEIGHT, to});
+
+    std::optional<Weight> best_weight;
+    std::optional<VertexId> meeting_vertex;
+    auto update_best = [&](VertexId vertex) {
+        if (forward.IsReached(vertex) && backward.IsReached(vertex)) {
+            const Weight weight = forward.weights[vertex] + backward.weights[vertex];
+            if (!best_weight || weight < *best_weight) {
+                best_weight = weight;
+                meeting_vertex = vertex;
+            }
+        }
+    };
+    update_best(from);
+
+    // Поиск вверх по иерархии в одном направлении. Направление
+    // прекращается, когда минимум очереди не меньше лучшего пути
+    auto step = [&](Queue& queue, SearchBuffers& current, bool is_forward) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (current.weights[vertex] < weight) {
+            return;
+        }
+        const auto& edge_ids = is_forward ? upward_edges_[vertex] : downward_edges_[vertex];
+        for (const EdgeId edge_id : edge_ids) {
+            const HierarchyEdge& edge = edges_[edge_id];
+            const VertexId next = is_forward ? edge.to : edge.from;
+            const Weight candidate_weight = weight + edge.weight;
+            if (!current.IsReached(next) || candidate_weight < current.weights[next]) {
+                current.Reach(next, candidate_weight, edge_id);
+                queue.push({candidate_weight, next});
+                update_best(next);
+            }
+        }
+    };
+
+    auto is_active = [&best_weight](const Queue& queue) {
+        return !queue.empty() && (!best_weight || queue.top().first < *best_weight);
+    };
+    while (is_active(forward_queue) || is_active(backward_queue)) {
+        const bool forward_turn = is_active(forward_queue)
+            && (!is_active(backward_queue)
+                || forward_queue.top().first <= backward_queue.top().first);
+        if (forward_turn) {
+            step(forward_queue, forward, true);
+        } else {
+            step(backward_queue, backward, false);
+        }
+    }
+
+    if (!meeting_vertex) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> hierarchy_edges;
+    for (std::optional<EdgeId> edge_id = forward.prev_edges[*meeting_vertex];
+         edge_id;
+         edge_id = forward.prev_edges[edges_[*edge_id].from])
+    {
+        hierarchy_edges.push_back(*edge_id);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (std::optional<EdgeId> edge_id = backward.prev_edges[*meeting_vertex];
+         edge_id;
+         edge_id = backward.prev_edges[edges_[*edge_id].to])
+    {
+        hierarchy_edges.push_back(*edge_id);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge_id : hierarchy_edges) {
+        UnpackEdge(edge_id, edges);
+    }
+
+    return RouteInfo{*best_weight, std::move(edges)};
+}
+
+}  // namespace graph
\ No newline at end of file
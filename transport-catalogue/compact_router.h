@@ -0,0 +1,295 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Предварительный расчёт всех маршрутов, как в Router, но таблица хранится
+// одним непрерывным массивом: вес типа StoredWeight и 32-битный номер
+// последнего ребра пути. Отсутствие маршрута и ребра обозначается
+// специальными значениями вместо std::optional.
+// Вес маршрута в ответе пересчитывается по рёбрам графа в типе Weight,
+// поэтому пониженная точность StoredWeight влияет только на выбор пути
+// среди почти равных по весу
+template <typename Weight, typename StoredWeight = float>
+class CompactRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    struct RouteInternalData {
+        StoredWeight weight;
+        uint32_t prev_edge;
+    };
+
+    explicit CompactRouter(const Graph& graph);
+
+    // Использовать готовую таблицу из GetVertexCount()^2 элементов,
+    // например отображённую в память из файла. owner продлевает
+    // время жизни памяти таблицы
+    CompactRouter(const Graph& graph, const RouteInternalData* routes,
+                  std::shared_ptr<const void> owner);
+
+    // Проверить готовую таблицу до её использования: последнее ребро каждого
+    // маршрута есть в графе и ведёт в конец маршрута, а маршрут без рёбер есть
+    // только из вершины в неё саму. Иначе таблица повреждена или построена
+    // для другого графа
+    static bool IsTableValid(const Graph& graph, const RouteInternalData* routes);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Вес пути суммируется по рёбрам графа, как в BuildRoute,
+    // но список рёбер не формируется
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Дополнить таблицу новыми вершинами и улучшить маршруты через новые рёбра.
+    // Готовая таблица при этом копируется в собственную
+    bool Update(EdgeId first_new_edge) override;
+
+    // Таблица маршрутов из GetVertexCount()^2 элементов, построчно
+    const RouteInternalData* GetRoutesData() const {
+        return routes_;
+    }
+
+private:
+    static constexpr StoredWeight NO_ROUTE = std::numeric_limits<StoredWeight>::has_infinity
+        ? std::numeric_limits<StoredWeight>::infinity()
+        : std::numeric_limits<StoredWeight>::max();
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+    RouteInternalData& GetRoute(VertexId from, VertexId to) {
+        return routes_internal_data_[from * vertex_count_ + to];
+    }
+    const RouteInternalData& GetRoute(VertexId from, VertexId to) const {
+        return routes_[from * vertex_count_ + to];
+    }
+
+    void InitializeRoutesInternalData(const Graph& graph) {
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            GetRoute(vertex, vertex) = {StoredWeight{}, NO_EDGE};
+            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
+                const auto& edge = graph.GetEdge(edge_id);
+                if (edge.weight < Weight{}) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const StoredWeight weight = static_cast<StoredWeight>(edge.weight);
+                auto& route = GetRoute(vertex, edge.to);
+                if (route.weight > weight) {
+                    route = {weight, static_cast<uint32_t>(edge_id)};
+                }
+            }
+        }
+    }
+
+    void RelaxRoutesInternalDataThroughVertex(VertexId vertex_through) {
+        const RouteInternalData* row_through = &GetRoute(vertex_through, 0);
+        for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+            RouteInternalData* row_from = &GetRoute(vertex_from, 0);
+            const RouteInternalData route_from = row_from[vertex_through];
+            if (route_from.weight == NO_ROUTE) {
+                continue;
+            }
+            // Строки вершин from и through читаются последовательно
+            for (VertexId vertex_to = 0; vertex_to < vertex_count_; ++vertex_to) {
+                const RouteInternalData& route_to = row_through[vertex_to];
+                if constexpr (!std::numeric_limits<StoredWeight>::has_infinity) {
+                    // Для чисел с плавающей точкой inf + x == inf, проверка не нужна
+                    if (route_to.weight == NO_ROUTE) {
+                        continue;
+                    }
+                }
+                const StoredWeight candidate_weight = route_from.weight + route_to.weight;
+                if (candidate_weight < row_from[vertex_to].weight) {
+                    row_from[vertex_to] = {candidate_weight,
+                        route_to.prev_edge != NO_EDGE ? route_to.prev_edge : route_from.prev_edge};
+                }
+            }
+        }
+    }
+
+    // Улучшить маршруты, которые становятся короче при проезде по ребру edge_id
+    void RelaxRoutesInternalDataThroughEdge(EdgeId edge_id) {
+        const auto& edge = graph_.GetEdgeUnchecked(edge_id);
+        const StoredWeight edge_weight = static_cast<StoredWeight>(edge.weight);
+        const RouteInternalData* row_to = &GetRoute(edge.to, 0);
+        for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+            RouteInternalData* row_from = &GetRoute(vertex_from, 0);
+            if (row_from[edge.from].weight == NO_ROUTE) {
+                continue;
+            }
+            const StoredWeight weight_through = row_from[edge.from].weight + edge_weight;
+            // Если ребро не сокращает путь до своего конца, строка не изменится
+            if (!(weight_through < row_from[edge.to].weight)) {
+                continue;
+            }
+            for (VertexId vertex_to = 0; vertex_to < vertex_count_; ++vertex_to) {
+                const RouteInternalData& route_to = row_to[vertex_to];
+                if (route_to.weight == NO_ROUTE) {
+                    continue;
+                }
+                const StoredWeight candidate_weight = weight_through + route_to.weight;
+                if (candidate_weight < row_from[vertex_to].weight) {
+                    row_from[vertex_to] = {candidate_weight,
+                        route_to.prev_edge != NO_EDGE ? route_to.prev_edge
+                                                      : static_cast<uint32_t>(edge_id)};
+                }
+            }
+        }
+    }
+
+    const Graph& graph_;
+    size_t vertex_count_;
+    // Собственная таблица, пуста при использовании готовой таблицы
+    std::vector<RouteInternalData> routes_internal_data_;
+    const RouteInternalData* routes_ = nullptr;
+    std::shared_ptr<const void> routes_owner_;
+};
+
+template <typename Weight, typename StoredWeight>
+CompactRouter<Weight, StoredWeight>::CompactRouter(const Graph& graph)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , routes_internal_data_(vertex_count_ * vertex_count_, RouteInternalData{NO_ROUTE, NO_EDGE})
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for compact routes table");
+    }
+    InitializeRoutesInternalData(graph);
+
+    for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+        RelaxRoutesInternalDataThroughVertex(vertex_through);
+    }
+    routes_ = routes_internal_data_.data();
+}
+
+template <typename Weight, typename StoredWeight>
+CompactRouter<Weight, StoredWeight>::CompactRouter(const Graph& graph,
+        const RouteInternalData* routes, std::shared_ptr<const void> owner)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , routes_(routes)
+    , routes_owner_(std::move(owner))
+{
+}
+
+template <typename Weight, typename StoredWeight>
+bool CompactRouter<Weight, StoredWeight>::IsTableValid(const Graph& graph,
+                                                       const RouteInternalData* routes) {
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+    for (VertexId from = 0; from < vertex_count; ++from) {
+        for (VertexId to = 0; to < vertex_count; ++to) {
+            const RouteInternalData& route = routes[from * vertex_count + to];
+            if (route.prev_edge == NO_EDGE) {
+                if (from != to && route.weight != NO_ROUTE) {
+                    return false;
+                }
+            } else if (route.prev_edge >= edge_count
+                       || graph.GetEdgeUnchecked(route.prev_edge).to != to) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Weight, typename StoredWeight>
+bool CompactRouter<Weight, StoredWeight>::Update(EdgeId first_new_edge) {
+    const size_t edge_count = graph_.GetEdgeCount();
+    if (edge_count >= NO_EDGE) {
+        throw std::length_error("Too many edges for compact routes table");
+    }
+    const size_t old_vertex_count = vertex_count_;
+    vertex_count_ = graph_.GetVertexCount();
+
+    // Переложить строки старой таблицы в таблицу нового размера
+    std::vector<RouteInternalData> routes(vertex_count_ * vertex_count_,
+                                          RouteInternalData{NO_ROUTE, NO_EDGE});
+    for (VertexId vertex_from = 0; vertex_from < old_vertex_count; ++vertex_from) {
+        std::copy(routes_ + vertex_from * old_vertex_count,
+                  routes_ + (vertex_from + 1) * old_vertex_count,
+                  routes.begin() + vertex_from * vertex_count_);
+    }
+    for (VertexId vertex = old_vertex_count; vertex < vertex_count_; ++vertex) {
+        routes[vertex * vertex_count_ + vertex] = {StoredWeight{}, NO_EDGE};
+    }
+    routes_internal_data_ = std::move(routes);
+    routes_ = routes_internal_data_.data();
+    routes_owner_.reset();
+
+    for (EdgeId edge_id = first_new_edge; edge_id < edge_count; ++edge_id) {
+        if (graph_.GetEdge(edge_id).weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        RelaxRoutesInternalDataThroughEdge(edge_id);
+    }
+    return true;
+}
+
+template <typename Weight, typename StoredWeight>
+std::vector<std::optional<Weight>> CompactRouter<Weight, StoredWeight>::ComputeWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    if (from >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (GetRoute(from, to).weight == NO_ROUTE) {
+            weights.push_back(std::nullopt);
+            continue;
+        }
+        Weight weight{};
+        for (uint32_t edge_id = GetRoute(from, to).prev_edge;
+             edge_id != NO_EDGE;
+             edge_id = GetRoute(from, graph_.GetEdgeUnchecked(edge_id).from).prev_edge)
+        {
+            weight += graph_.GetEdgeUnchecked(edge_id).weight;
+        }
+        weights.push_back(weight);
+    }
+    return weights;
+}
+
+template <typename Weight, typename StoredWeight>
+std::optional<typename CompactRouter<Weight, StoredWeight>::RouteInfo>
+CompactRouter<Weight, StoredWeight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (GetRoute(from, to).weight == NO_ROUTE) {
+        return std::nullopt;
+    }
+    Weight weight{};
+    std::vector<EdgeId> edges;
+    for (uint32_t edge_id = GetRoute(from, to).prev_edge;
+         edge_id != NO_EDGE;
+         edge_id = GetRoute(from, graph_.GetEdgeUnchecked(edge_id).from).prev_edge)
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdgeUnchecked(edge_id).weight;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "graph.h"
+#include "radix_heap.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+namespace detail {
+
+// Рабочие буферы поиска. Хранятся отдельно для каждого потока, чтобы
+// не выделять память на каждый запрос. Метка поколения позволяет
+// не очищать массивы между запросами
+template <typename Weight>
+struct SearchBuffers {
+    std::vector<Weight> weights;
+    std::vector<std::optional<EdgeId>> prev_edges;
+    std::vector<uint32_t> generations;
+    uint32_t generation = 0;
+
+    void Prepare(size_t vertex_count) {
+        if (generations.size() < vertex_count) {
+            weights.resize(vertex_count);
+            prev_edges.resize(vertex_count);
+            generations.resize(vertex_count, 0);
+        }
+        if (++generation == 0) {
+            std::fill(generations.begin(), generations.end(), 0);
+            generation = 1;
+        }
+    }
+    bool IsReached(VertexId vertex) const {
+        return generations[vertex] == generation;
+    }
+    void Reach(VertexId vertex, Weight weight, std::optional<EdgeId> prev_edge) {
+        generations[vertex] = generation;
+        weights[vertex] = weight;
+        prev_edges[vertex] = prev_edge;
+    }
+};
+
+// Очередь вершин поиска Дейкстры. Для беззнаковых целых весов - поразрядная
+// куча, для остальных - двоичная
+template <typename Weight>
+using DijkstraQueue = std::conditional_t<std::is_integral_v<Weight> && std::is_unsigned_v<Weight>,
+    RadixHeap<Weight, VertexId>,
+    std::priority_queue<std::pair<Weight, VertexId>, std::vector<std::pair<Weight, VertexId>>,
+                        std::greater<std::pair<Weight, VertexId>>>>;
+
+// Что делать с вершиной, вес пути до которой окончательно найден
+enum class SettleAction {
+    // Просмотреть рёбра вершины
+    RELAX,
+    // Не просматривать рёбра вершины и продолжить поиск
+    SKIP,
+    // Остановить поиск
+    STOP,
+};
+
+// Поиск Дейкстры из from по исходящим рёбрам или, если is_forward == false,
+// по входящим, то есть поиск путей до from. Для каждой вершины в порядке
+// возрастания веса пути вызывается settle(vertex, weight, prev_edge), где
+// prev_edge - ребро пути, смежное с vertex. Веса и рёбра путей остаются
+// в buffers. При равном весе остаётся путь, найденный первым.
+// Граф должен быть заморожен
+template <typename Weight, typename Settle>
+void RunDijkstra(const DirectedWeightedGraph<Weight>& graph, SearchBuffers<Weight>& buffers,
+                 VertexId from, bool is_forward, Settle&& settle) {
+    DijkstraQueue<Weight> queue;
+    buffers.Prepare(graph.GetVertexCount());
+    buffers.Reach(from, Weight{}, std::nullopt);
+    queue.push({Weight{}, from});
+    while (!queue.empty()) {
+        const auto [weight, vertex] = queue.top();
+        queue.pop();
+        if (buffers.weights[vertex] < weight) {
+            // Устаревший элемент очереди
+            continue;
+        }
+        const SettleAction action = settle(vertex, weight, buffers.prev_edges[vertex]);
+        if (action == SettleAction::STOP) {
+            return;
+        }
+        if (action == SettleAction::SKIP) {
+            continue;
+        }
+        const auto arcs = is_forward ? graph.GetOutgoingArcs(vertex)
+                                     : graph.GetIncomingArcs(vertex);
+        for (const auto& arc : arcs) {
+            const Weight candidate_weight = weight + arc.weight;
+            if (!buffers.IsReached(arc.vertex) || candidate_weight < buffers.weights[arc.vertex]) {
+                buffers.Reach(arc.vertex, candidate_weight, arc.edge_id);
+                queue.push({candidate_weight, arc.vertex});
+            }
+        }
+    }
+}
+
+// Веса кратчайших путей из from до вершин targets одним поиском Дейкстры.
+// Поиск останавливается, когда обработаны все вершины targets.
+// Граф должен быть заморожен
+template <typename Weight>
+std::vector<std::optional<Weight>> ComputeWeightsFromVertex(
+        const DirectedWeightedGraph<Weight>& graph, SearchBuffers<Weight>& buffers,
+        VertexId from, const std::vector<VertexId>& targets) {
+    const size_t vertex_count = graph.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    // Вершины targets, которые ещё не обработаны
+    std::vector<bool> is_target(vertex_count, false);
+    size_t targets_left = 0;
+    for (const VertexId to : targets) {
+        if (to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (!is_target[to]) {
+            is_target[to] = true;
+            ++targets_left;
+        }
+    }
+
+    if (targets_left > 0) {
+        RunDijkstra(graph, buffers, from, true,
+            [&is_target, &targets_left](VertexId vertex, Weight, std::optional<EdgeId>) {
+                if (is_target[vertex]) {
+                    is_target[vertex] = false;
+                    if (--targets_left == 0) {
+                        return SettleAction::STOP;
+                    }
+                }
+                return SettleAction::RELAX;
+            });
+    }
+
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        weights.push_back(buffers.IsReached(to) ? std::optional<Weight>(buffers.weights[to])
+                                                : std::nullopt);
+    }
+    return weights;
+}
+
+}  // namespace detail
+
+// Вершины, достижимые из from по пути весом не больше max_weight, и веса
+// кратчайших путей до них в порядке возрастания. Поиск не продолжается
+// дальше max_weight. Граф должен быть заморожен
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> FindReachableVertices(
+        const DirectedWeightedGraph<Weight>& graph, VertexId from, Weight max_weight) {
+    const size_t vertex_count = graph.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    std::vector<std::pair<VertexId, Weight>> result;
+    if (max_weight < Weight{}) {
+        return result;
+    }
+    thread_local detail::SearchBuffers<Weight> buffers;
+    detail::RunDijkstra(graph, buffers, from, true,
+        [&result, max_weight](VertexId vertex, Weight weight, std::optional<EdgeId>) {
+            if (max_weight < weight) {
+                return detail::SettleAction::STOP;
+            }
+            result.push_back({vertex, weight});
+            return detail::SettleAction::RELAX;
+        });
+    return result;
+}
+
+// Поиск кратчайшего пути алгоритмом Дейкстры в момент запроса.
+// В отличие от Router не требует O(V^2) памяти и предварительного расчёта.
+// Граф должен быть заморожен (DirectedWeightedGraph::Freeze)
+template <typename Weight>
+class DijkstraRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override {
+        return detail::ComputeWeightsFromVertex(graph_, GetBuffers(), from, targets);
+    }
+
+private:
+    using SearchBuffers = detail::SearchBuffers<Weight>;
+
+    static SearchBuffers& GetBuffers() {
+        thread_local SearchBuffers buffers;
+        return buffers;
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    const Graph& graph_;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+{
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Graph should be frozen");
+    }
+    const size_t edge_count = graph.GetEdgeCount();
+    for (EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    SearchBuffers& buffers = GetBuffers();
+    bool target_settled = false;
+    detail::RunDijkstra(graph_, buffers, from, true,
+        [to, &target_settled](VertexId vertex, Weight, std::optional<EdgeId>) {
+            if (vertex == to) {
+                // Вершина назначения окончательно обработана
+                target_settled = true;
+                return detail::SettleAction::STOP;
+            }
+            return detail::SettleAction::RELAX;
+        });
+
+    if (!target_settled) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = buffers.prev_edges[to];
+         edge_id;
+         edge_id = buffers.prev_edges[graph_.GetEdgeUnchecked(*edge_id).from])
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{buffers.weights[to], std::move(edges)};
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -18,4 +18,14 @@ int Bus::CountUniqueStops() const {
     auto last = std::unique(tmp.begin(), tmp.end());
     return static_cast<int>(last - tmp.begin());
 }
+
+std::vector<const Stop*> Bus::GetRoundedStops() const {
+    std::vector<const Stop*> rounded_stops = stops;
+    if (!is_roundtrip && !stops.empty()) {
+        for (auto it = stops.rbegin() + 1; it != stops.rend(); ++it) {
+            rounded_stops.push_back(*it);
+        }
+    }
+    return rounded_stops;
+}
 }  // namespace tcat
\ No newline at end of file
@@ -23,6 +23,9 @@ struct Bus {
     bool is_roundtrip = false;
     int StopCount() const;
     int CountUniqueStops() const;
+    // Остановки маршрута. Некольцевой маршрут дополняется обратным путём,
+    // чтобы его можно было рассматривать как кольцевой
+    std::vector<const Stop*> GetRoundedStops() const;
 };
 
 }  // namespace tcat
\ No newline at end of file
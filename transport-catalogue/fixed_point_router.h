@@ -0,0 +1,147 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Поиск по копии графа с целыми весами в фиксированной точке: вес ребра
+// умножается на scale и округляется вверх до FixedWeight. Целый вес ребра
+// не меньше исходного, поэтому нижние оценки расстояния по исходным весам,
+// округлённые вниз, остаются нижними и для целых весов. Целые сравниваются
+// быстрее и без погрешностей, пути равного веса сравниваются точно,
+// а поиск Дейкстры с беззнаковым целым весом использует поразрядную кучу.
+// Целые веса нужны только для поиска: вес найденного маршрута - сумма
+// исходных весов его рёбер, как если бы маршрут нашёл поиск по исходному графу.
+// Маршрутизатор для целочисленного графа создаётся функцией make_router
+template <typename Weight, typename FixedWeight>
+class FixedPointRouter : public RouterBase<Weight> {
+    static_assert(std::is_integral_v<FixedWeight>, "Fixed-point weight should be integral");
+
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+    using FixedGraph = DirectedWeightedGraph<FixedWeight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+    using RouterFactory = std::function<std::unique_ptr<RouterBase<FixedWeight>>(const FixedGraph&)>;
+
+    FixedPointRouter(const Graph& graph, Weight scale, RouterFactory make_router);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Маршрут до каждой из targets ищется отдельно, чтобы сложить исходные веса рёбер
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Добавить новые вершины и рёбра в целочисленный граф
+    bool Update(EdgeId first_new_edge) override;
+
+private:
+    FixedWeight ToFixed(Weight weight) const;
+
+    // Сумма исходных весов рёбер в порядке пути
+    Weight SumWeights(const std::vector<EdgeId>& edges) const {
+        Weight weight{};
+        for (const EdgeId edge_id : edges) {
+            weight += graph_.GetEdgeUnchecked(edge_id).weight;
+        }
+        return weight;
+    }
+
+    // Скопировать в целочисленный граф вершины и рёбра от first_new_edge
+    void AddNewEdges(EdgeId first_new_edge);
+
+    const Graph& graph_;
+    Weight scale_;
+    RouterFactory make_router_;
+    FixedGraph fixed_graph_;
+    std::unique_ptr<RouterBase<FixedWeight>> router_;
+};
+
+template <typename Weight, typename FixedWeight>
+FixedPointRouter<Weight, FixedWeight>::FixedPointRouter(const Graph& graph, Weight scale,
+                                                        RouterFactory make_router)
+    : graph_(graph)
+    , scale_(scale)
+    , make_router_(std::move(make_router))
+{
+    if (!(scale > Weight{})) {
+        throw std::domain_error("Fixed-point scale should be positive");
+    }
+    AddNewEdges(0);
+    router_ = make_router_(fixed_graph_);
+}
+
+template <typename Weight, typename FixedWeight>
+FixedWeight FixedPointRouter<Weight, FixedWeight>::ToFixed(Weight weight) const {
+    if (weight < Weight{}) {
+        throw std::domain_error("Edges' weights should be non-negative");
+    }
+    const Weight fixed_weight = std::ceil(weight * scale_);
+    if (!(fixed_weight <= static_cast<Weight>(std::numeric_limits<FixedWeight>::max()))) {
+        throw std::overflow_error("Edge weight is too large for fixed-point weight");
+    }
+    return static_cast<FixedWeight>(fixed_weight);
+}
+
+template <typename Weight, typename FixedWeight>
+void FixedPointRouter<Weight, FixedWeight>::AddNewEdges(EdgeId first_new_edge) {
+    fixed_graph_.Unfreeze();
+    while (fixed_graph_.GetVertexCount() < graph_.GetVertexCount()) {
+        fixed_graph_.AddVertex();
+    }
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (EdgeId edge_id = first_new_edge; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        fixed_graph_.AddEdge({edge.from, edge.to, ToFixed(edge.weight)});
+    }
+    fixed_graph_.Freeze();
+}
+
+template <typename Weight, typename FixedWeight>
+bool FixedPointRouter<Weight, FixedWeight>::Update(EdgeId first_new_edge) {
+    AddNewEdges(first_new_edge);
+    if (!router_->Update(first_new_edge)) {
+        router_ = make_router_(fixed_graph_);
+    }
+    return true;
+}
+
+template <typename Weight, typename FixedWeight>
+std::optional<typename FixedPointRouter<Weight, FixedWeight>::RouteInfo>
+FixedPointRouter<Weight, FixedWeight>::BuildRoute(VertexId from, VertexId to) const {
+    auto route = router_->BuildRoute(from, to);
+    if (!route) {
+        return std::nullopt;
+    }
+    const Weight weight = SumWeights(route->edges);
+    return RouteInfo{weight, std::move(route->edges)};
+}
+
+template <typename Weight, typename FixedWeight>
+std::vector<std::optional<Weight>> FixedPointRouter<Weight, FixedWeight>::ComputeWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (auto route = router_->BuildRoute(from, to)) {
+            weights.push_back(SumWeights(route->edges));
+        } else {
+            weights.push_back(std::nullopt);
+        }
+    }
+    return weights;
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -2,7 +2,9 @@
 
 #include "ranges.h"
 
+#include <cassert>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -17,38 +19,92 @@ struct Edge {
     Weight weight;
 };
 
-// Взвешенный ориентированный граф
+// Ребро в списке смежности замороженного графа
+template <typename Weight>
+struct Arc {
+    EdgeId edge_id;
+    // Конец ребра для исходящих рёбер, начало - для входящих
+    VertexId vertex;
+    Weight weight;
+};
+
+// Взвешенный ориентированный граф.
+// После вызова Freeze() рёбра добавлять нельзя, зато доступны списки смежности
+// в формате CSR: рёбра всех вершин лежат в одном массиве подряд
+// вместе с концом и весом, что ускоряет обход в поиске кратчайшего пути
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
     using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using ArcsRange = ranges::Range<const Arc<Weight>*>;
 
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
+    VertexId AddVertex();
     EdgeId AddEdge(const Edge<Weight>& edge);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    // Ребро без проверки границ, для номеров рёбер, полученных из самого графа
+    const Edge<Weight>& GetEdgeUnchecked(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+    // Рёбра, входящие в вершину
+    IncidentEdgesRange GetIncomingEdges(VertexId vertex) const;
+
+    // Построить CSR-представление. Повторный вызов ничего не делает
+    void Freeze();
+    // Разрешить добавление вершин и рёбер, CSR-представление удаляется
+    void Unfreeze();
+    bool IsFrozen() const;
+    // Исходящие и входящие рёбра замороженного графа, без проверки границ
+    ArcsRange GetOutgoingArcs(VertexId vertex) const;
+    ArcsRange GetIncomingArcs(VertexId vertex) const;
 
 private:
+    // Заполнить CSR-массивы по спискам смежности
+    void BuildArcs(const std::vector<IncidenceList>& lists, bool is_outgoing,
+                   std::vector<size_t>& offsets, std::vector<Arc<Weight>>& arcs) const;
+
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+    std::vector<IncidenceList> reverse_incidence_lists_;
+
+    bool is_frozen_ = false;
+    // Рёбра вершины v занимают [offsets[v], offsets[v + 1]) в массиве arcs
+    std::vector<size_t> out_offsets_;
+    std::vector<Arc<Weight>> out_arcs_;
+    std::vector<size_t> in_offsets_;
+    std::vector<Arc<Weight>> in_arcs_;
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : incidence_lists_(vertex_count)
+    , reverse_incidence_lists_(vertex_count) {
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::AddVertex() {
+    if (is_frozen_) {
+        throw std::logic_error("Can't add vertex to frozen graph");
+    }
+    incidence_lists_.emplace_back();
+    reverse_incidence_lists_.emplace_back();
+    return incidence_lists_.size() - 1;
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (is_frozen_) {
+        throw std::logic_error("Can't add edge to frozen graph");
+    }
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
+    reverse_incidence_lists_.at(edge.to).push_back(id);
     return id;
 }
 
@@ -67,9 +123,78 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
     return edges_.at(edge_id);
 }
 
+template <typename Weight>
+const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdgeUnchecked(EdgeId edge_id) const {
+    assert(edge_id < edges_.size());
+    return edges_[edge_id];
+}
+
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
+DirectedWeightedGraph<Weight>::GetIncomingEdges(VertexId vertex) const {
+    return ranges::AsRange(reverse_incidence_lists_.at(vertex));
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (is_frozen_) {
+        return;
+    }
+    BuildArcs(incidence_lists_, true, out_offsets_, out_arcs_);
+    BuildArcs(reverse_incidence_lists_, false, in_offsets_, in_arcs_);
+    is_frozen_ = true;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Unfreeze() {
+    is_frozen_ = false;
+    out_offsets_.clear();
+    out_arcs_.clear();
+    in_offsets_.clear();
+    in_arcs_.clear();
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::BuildArcs(const std::vector<IncidenceList>& lists,
+        bool is_outgoing, std::vector<size_t>& offsets, std::vector<Arc<Weight>>& arcs) const {
+    offsets.clear();
+    offsets.reserve(lists.size() + 1);
+    arcs.clear();
+    arcs.reserve(edges_.size());
+    offsets.push_back(0);
+    for (const IncidenceList& list : lists) {
+        for (const EdgeId edge_id : list) {
+            const Edge<Weight>& edge = edges_[edge_id];
+            arcs.push_back({edge_id, is_outgoing ? edge.to : edge.from, edge.weight});
+        }
+        offsets.push_back(arcs.size());
+    }
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return is_frozen_;
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::ArcsRange
+DirectedWeightedGraph<Weight>::GetOutgoingArcs(VertexId vertex) const {
+    assert(is_frozen_ && vertex + 1 < out_offsets_.size());
+    const Arc<Weight>* arcs = out_arcs_.data();
+    return {arcs + out_offsets_[vertex], arcs + out_offsets_[vertex + 1]};
+}
+
+template <typename Weight>
+typename DirectedWeightedGraph<Weight>::ArcsRange
+DirectedWeightedGraph<Weight>::GetIncomingArcs(VertexId vertex) const {
+    assert(is_frozen_ && vertex + 1 < in_offsets_.size());
+    const Arc<Weight>* arcs = in_arcs_.data();
+    return {arcs + in_offsets_[vertex], arcs + in_offsets_[vertex + 1]};
+}
 }  // namespace graph
\ No newline at end of file
@@ -0,0 +1,419 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Двухточечные метки (hub labeling). Для каждой вершины v хранятся исходящая
+// метка - вершины-хабы, достижимые из v, с весами путей до них, и входящая -
+// хабы, из которых достижима v. Для любой пары вершин кратчайший путь проходит
+// через хаб, общий для исходящей метки начала и входящей метки конца, поэтому
+// вес пути находится слиянием двух отсортированных массивов без поиска в графе.
+// Метки строятся алгоритмом pruned landmark labeling: вершины по очереди
+// в порядке убывания важности (числа кратчайших путей через вершину
+// в нескольких деревьях кратчайших путей) становятся хабами, и из каждой выполняется поиск
+// Дейкстры в прямом и обратном графе. Поиск не продолжается из вершины,
+// путь до которой уже покрывают метки более важных хабов, поэтому метки
+// обычно намного меньше таблицы O(V^2) маршрутизатора Router.
+// Для каждого элемента метки хранится ребро пути, смежное с вершиной:
+// по цепочке таких рёбер путь до хаба восстанавливается целиком.
+// Граф должен быть заморожен (DirectedWeightedGraph::Freeze)
+template <typename Weight>
+class HubLabelRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+    struct LabelEntry {
+        // Номер хаба в порядке важности. Элементы метки отсортированы по нему
+        uint32_t hub;
+        // Первое ребро пути до хаба в исходящей метке, последнее ребро пути
+        // от хаба во входящей. NO_EDGE - вершина сама является хабом
+        uint32_t edge;
+        Weight weight;
+    };
+
+    explicit HubLabelRouter(const Graph& graph);
+
+    // Использовать готовые метки, например отображённые в память из файла.
+    // offsets - 2 * GetVertexCount() + 1 смещений меток в entries: сначала
+    // исходящие метки всех вершин, затем входящие. owner продлевает время
+    // жизни памяти меток
+    HubLabelRouter(const Graph& graph, const uint64_t* offsets, const LabelEntry* entries,
+                   std::shared_ptr<const void> owner);
+
+    // Проверить готовые метки из entry_count элементов до их использования:
+    // смещения не убывают и заканчиваются на entry_count, номера хабов меньше
+    // числа вершин и возрастают внутри метки, рёбра есть в графе и смежны
+    // с вершиной своей метки. Иначе метки повреждены или построены для другого графа
+    static bool AreLabelsValid(const Graph& graph, const uint64_t* offsets,
+                               const LabelEntry* entries, size_t entry_count);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Вес каждого пути - результат слияния меток, рёбра пути не восстанавливаются
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Новые рёбра могут сократить пути, которые метки уже покрывают.
+    // Метки строятся заново
+    bool Update(EdgeId /*first_new_edge*/) override {
+        return false;
+    }
+
+    const uint64_t* GetOffsetsData() const {
+        return offsets_;
+    }
+
+    const LabelEntry* GetEntriesData() const {
+        return entries_;
+    }
+
+    size_t GetEntryCount() const {
+        return offsets_[2 * vertex_count_];
+    }
+
+private:
+    static constexpr Weight NO_WEIGHT = std::numeric_limits<Weight>::max();
+    static constexpr VertexId NO_VERTEX = std::numeric_limits<VertexId>::max();
+    // Число деревьев кратчайших путей для оценки важности вершин
+    static constexpr size_t ORDER_SAMPLE_COUNT = 32;
+
+    struct Label {
+        const LabelEntry* begin;
+        const LabelEntry* end;
+    };
+
+    Label GetOutLabel(VertexId vertex) const {
+        return {entries_ + offsets_[vertex], entries_ + offsets_[vertex + 1]};
+    }
+    Label GetInLabel(VertexId vertex) const {
+        return {entries_ + offsets_[vertex_count_ + vertex],
+                entries_ + offsets_[vertex_count_ + vertex + 1]};
+    }
+
+    // Вершины в порядке убывания важности
+    std::vector<VertexId> OrderVertices() const;
+
+    void BuildLabels();
+
+    // Элемент метки с наименьшим весом суммы среди общих хабов
+    // исходящей метки out и входящей метки in
+    std::optional<std::pair<const LabelEntry*, const LabelEntry*>> FindBestHub(
+            Label out, Label in) const;
+
+    // Элемент метки вершины для хаба hub
+    static const LabelEntry& FindEntry(Label label, uint32_t hub);
+
+    void CheckVertex(VertexId vertex) const;
+
+    const Graph& graph_;
+    size_t vertex_count_;
+    // Собственные метки, пусты при использовании готовых
+    std::vector<uint64_t> offsets_data_;
+    std::vector<LabelEntry> entries_data_;
+    const uint64_t* offsets_ = nullptr;
+    const LabelEntry* entries_ = nullptr;
+    std::shared_ptr<const void> labels_owner_;
+};
+
+template <typename Weight>
+HubLabelRouter<Weight>::HubLabelRouter(const Graph& graph)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+{
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Graph should be frozen");
+    }
+    if (graph.GetEdgeCount() >= NO_EDGE || vertex_count_ >= NO_EDGE) {
+        throw std::length_error("Graph is too large for hub labels");
+    }
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    BuildLabels();
+    offsets_ = offsets_data_.data();
+    entries_ = entries_data_.data();
+}
+
+template <typename Weight>
+HubLabelRouter<Weight>::HubLabelRouter(const Graph& graph, const uint64_t* offsets,
+        const LabelEntry* entries, std::shared_ptr<const void> owner)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+    , offsets_(offsets)
+    , entries_(entries)
+    , labels_owner_(std::move(owner))
+{
+}
+
+template <typename Weight>
+bool HubLabelRouter<Weight>::AreLabelsValid(const Graph& graph, const uint64_t* offsets,
+                                            const LabelEntry* entries, size_t entry_count) {
+    const size_t vertex_count = graph.GetVertexCount();
+    const size_t edge_count = graph.GetEdgeCount();
+    const size_t label_count = 2 * vertex_count;
+    if (offsets[0] != 0 || offsets[label_count] != entry_count
+        || !std::is_sorted(offsets, offsets + label_count + 1)) {
+        return false;
+    }
+    for (size_t label = 0; label < label_count; ++label) {
+        const bool is_out_label = label < vertex_count;
+        const VertexId vertex = is_out_label ? label : label - vertex_count;
+        for (uint64_t i = offsets[label]; i < offsets[label + 1]; ++i) {
+            const LabelEntry& entry = entries[i];
+            if (entry.hub >= vertex_count
+                || (i > offsets[label] && !(entries[i - 1].hub < entry.hub))) {
+                return false;
+            }
+            if (entry.edge == NO_EDGE) {
+                continue;
+            }
+            if (entry.edge >= edge_count) {
+                return false;
+            }
+            const auto& edge = graph.GetEdgeUnchecked(entry.edge);
+            if ((is_out_label ? edge.from : edge.to) != vertex) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Weight>
+std::vector<VertexId> HubLabelRouter<Weight>::OrderVertices() const {
+    // Важность вершины - суммарное число потомков в деревьях кратчайших путей
+    // из нескольких равномерно выбранных вершин: через вершину с большим
+    // поддеревом проходит много кратчайших путей
+    std::vector<uint64_t> importance(vertex_count_, 0);
+    std::vector<VertexId> parents(vertex_count_);
+    std::vector<uint64_t> subtree_sizes(vertex_count_);
+    std::vector<VertexId> settled;
+    detail::SearchBuffers<Weight> buffers;
+    const size_t sample_count = std::min(vertex_count_, ORDER_SAMPLE_COUNT);
+    for (size_t sample = 0; sample < sample_count; ++sample) {
+        const VertexId root = static_cast<VertexId>(sample * vertex_count_ / sample_count);
+        settled.clear();
+        detail::RunDijkstra(graph_, buffers, root, true,
+            [this, &settled, &parents, &subtree_sizes](VertexId vertex, Weight,
+                                                      std::optional<EdgeId> prev_edge) {
+                settled.push_back(vertex);
+                subtree_sizes[vertex] = 1;
+                parents[vertex] = prev_edge ? graph_.GetEdgeUnchecked(*prev_edge).from : NO_VERTEX;
+                return detail::SettleAction::RELAX;
+            });
+        // Потомки обработаны позже предков, размеры поддеревьев
+        // накапливаются в обратном порядке
+        for (auto it = settled.rbegin(); it != settled.rend(); ++it) {
+            importance[*it] += subtree_sizes[*it];
+            if (parents[*it] != NO_VERTEX) {
+                subtree_sizes[parents[*it]] += subtree_sizes[*it];
+            }
+        }
+    }
+
+    // При равной важности первой идёт вершина с большим числом рёбер
+    const auto get_degree = [this](VertexId vertex) {
+        const auto out_arcs = graph_.GetOutgoingArcs(vertex);
+        const auto in_arcs = graph_.GetIncomingArcs(vertex);
+        return (out_arcs.end() - out_arcs.begin()) + (in_arcs.end() - in_arcs.begin());
+    };
+    std::vector<VertexId> order(vertex_count_);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        order[vertex] = vertex;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&importance, &get_degree](VertexId lhs, VertexId rhs) {
+            if (importance[lhs] != importance[rhs]) {
+                return importance[lhs] > importance[rhs];
+            }
+            return get_degree(lhs) > get_degree(rhs);
+        });
+    return order;
+}
+
+template <typename Weight>
+void HubLabelRouter<Weight>::BuildLabels() {
+    // Метки строятся по вершинам, затем укладываются в один массив
+    std::vector<std::vector<LabelEntry>> out_labels(vertex_count_);
+    std::vector<std::vector<LabelEntry>> in_labels(vertex_count_);
+
+    // Веса путей от хаба поиска до более важных хабов по его метке, по номерам хабов
+    std::vector<Weight> hub_weights(vertex_count_, NO_WEIGHT);
+    detail::SearchBuffers<Weight> buffers;
+
+    // Поиск из хаба root с номером hub в прямом (is_forward) или обратном графе.
+    // Найденные пути добавляются во входящие или исходящие метки вершин
+    const auto pruned_search = [&](VertexId root, uint32_t hub, bool is_forward) {
+        const std::vector<LabelEntry>& root_label = is_forward ? out_labels[root]
+                                                               : in_labels[root];
+        std::vector<std::vector<LabelEntry>>& labels = is_forward ? in_labels : out_labels;
+        for (const LabelEntry& entry : root_label) {
+            hub_weights[entry.hub] = entry.weight;
+        }
+
+        detail::RunDijkstra(graph_, buffers, root, is_forward,
+            [root, hub, &labels, &hub_weights](VertexId vertex, Weight weight,
+                                               std::optional<EdgeId> prev_edge) {
+                std::vector<LabelEntry>& label = labels[vertex];
+                if (vertex != root) {
+                    // Путь через более важный хаб не длиннее - метки уже покрывают
+                    // пути через эту вершину
+                    const bool is_covered = std::any_of(label.begin(), label.end(),
+                        [&hub_weights, weight](const LabelEntry& entry) {
+                            return hub_weights[entry.hub] != NO_WEIGHT
+                                && !(weight < hub_weights[entry.hub] + entry.weight);
+                        });
+                    if (is_covered) {
+                        return detail::SettleAction::SKIP;
+                    }
+                }
+                const uint32_t edge = prev_edge ? static_cast<uint32_t>(*prev_edge) : NO_EDGE;
+                label.push_back({hub, edge, weight});
+                return detail::SettleAction::RELAX;
+            });
+
+        for (const LabelEntry& entry : root_label) {
+            hub_weights[entry.hub] = NO_WEIGHT;
+        }
+    };
+
+    const std::vector<VertexId> order = OrderVertices();
+    for (uint32_t hub = 0; hub < vertex_count_; ++hub) {
+        pruned_search(order[hub], hub, true);
+        pruned_search(order[hub], hub, false);
+    }
+
+    offsets_data_.reserve(2 * vertex_count_ + 1);
+    offsets_data_.push_back(0);
+    size_t entry_count = 0;
+    for (const auto* labels : {&out_labels, &in_labels}) {
+        for (const std::vector<LabelEntry>& label : *labels) {
+            entry_count += label.size();
+            offsets_data_.push_back(entry_count);
+        }
+    }
+    entries_data_.reserve(entry_count);
+    for (auto* labels : {&out_labels, &in_labels}) {
+        for (std::vector<LabelEntry>& label : *labels) {
+            entries_data_.insert(entries_data_.end(), label.begin(), label.end());
+            std::vector<LabelEntry>().swap(label);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<std::pair<const typename HubLabelRouter<Weight>::LabelEntry*,
+                        const typename HubLabelRouter<Weight>::LabelEntry*>>
+HubLabelRouter<Weight>::FindBestHub(Label out, Label in) const {
+    std::optional<std::pair<const LabelEntry*, const LabelEntry*>> best;
+    Weight best_weight{};
+    const LabelEntry* out_entry = out.begin;
+    const LabelEntry* in_entry = in.begin;
+    while (out_entry != out.end && in_entry != in.end) {
+        if (out_entry->hub < in_entry->hub) {
+            ++out_entry;
+        } else if (in_entry->hub < out_entry->hub) {
+            ++in_entry;
+        } else {
+            const Weight weight = out_entry->weight + in_entry->weight;
+            if (!best || weight < best_weight) {
+                best = {out_entry, in_entry};
+                best_weight = weight;
+            }
+            ++out_entry;
+            ++in_entry;
+        }
+    }
+    return best;
+}
+
+template <typename Weight>
+const typename HubLabelRouter<Weight>::LabelEntry& HubLabelRouter<Weight>::FindEntry(
+        Label label, uint32_t hub) {
+    const LabelEntry* entry = std::lower_bound(label.begin, label.end, hub,
+        [](const LabelEntry& lhs, uint32_t rhs) {
+            return lhs.hub < rhs;
+        });
+    if (entry == label.end || entry->hub != hub) {
+        throw std::logic_error("Hub labels are inconsistent");
+    }
+    return *entry;
+}
+
+template <typename Weight>
+void HubLabelRouter<Weight>::CheckVertex(VertexId vertex) const {
+    if (vertex >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> HubLabelRouter<Weight>::ComputeWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    CheckVertex(from);
+    const Label out = GetOutLabel(from);
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        CheckVertex(to);
+        if (const auto best = FindBestHub(out, GetInLabel(to))) {
+            weights.push_back(best->first->weight + best->second->weight);
+        } else {
+            weights.push_back(std::nullopt);
+        }
+    }
+    return weights;
+}
+
+template <typename Weight>
+std::optional<typename HubLabelRouter<Weight>::RouteInfo>
+HubLabelRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    CheckVertex(from);
+    CheckVertex(to);
+    const auto best = FindBestHub(GetOutLabel(from), GetInLabel(to));
+    if (!best) {
+        return std::nullopt;
+    }
+    const uint32_t hub = best->first->hub;
+
+    // Путь до хаба - по первым рёбрам из исходящих меток
+    std::vector<EdgeId> edges;
+    for (uint32_t edge_id = best->first->edge; edge_id != NO_EDGE;) {
+        edges.push_back(edge_id);
+        edge_id = FindEntry(GetOutLabel(graph_.GetEdgeUnchecked(edge_id).to), hub).edge;
+    }
+    // Путь от хаба - по последним рёбрам из входящих меток, с конца
+    const size_t hub_position = edges.size();
+    for (uint32_t edge_id = best->second->edge; edge_id != NO_EDGE;) {
+        edges.push_back(edge_id);
+        edge_id = FindEntry(GetInLabel(graph_.GetEdgeUnchecked(edge_id).from), hub).edge;
+    }
+    std::reverse(edges.begin() + hub_position, edges.end());
+
+    Weight weight{};
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdgeUnchecked(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
\ No newline at end of file
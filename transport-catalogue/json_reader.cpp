@@ -5,8 +5,11 @@
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
 using namespace std::literals;
@@ -35,6 +38,112 @@ namespace {
         }
         return svg::Color{node.AsString()};
     }
+
+    // Записать время и элементы маршрута в текущий словарь
+    void WriteRoute(json::DictItemContext dict_builder, const trouter::RouteInfo& route_info) {
+        dict_builder.Key("total_time"s).Value(route_info.total_time);
+        json::ArrayValueContext array_builder = dict_builder.Key("items"s).StartArray();
+        for (const trouter::RouteInfo::Item& item : route_info.parts) {
+            json::DictItemContext item_dict_builder = array_builder.StartDict();
+            if (std::holds_alternative<trouter::WaitItem>(item)) {
+                const trouter::WaitItem& wait_item = std::get<trouter::WaitItem>(item);
+                item_dict_builder.Key("type"s).Value("Wait");
+                item_dict_builder.Key("stop_name"s).Value(std::string(wait_item.stop_name));
+                item_dict_builder.Key("time"s).Value(wait_item.time);
+            } else if (std::holds_alternative<trouter::BusItem>(item)) {
+                const trouter::BusItem& bus_item = std::get<trouter::BusItem>(item);
+                item_dict_builder.Key("type"s).Value("Bus");
+                item_dict_builder.Key("bus"s).Value(std::string(bus_item.bus_name));
+                item_dict_builder.Key("span_count"s).Value(bus_item.span_count);
+                item_dict_builder.Key("time"s).Value(bus_item.time);
+            }
+            item_dict_builder.EndDict();
+        }
+        array_builder.EndArray();
+    }
+
+    // Наибольшее число альтернативных маршрутов в запросе Route. Число путей
+    // в графе растёт экспоненциально, поэтому запрос без предела может
+    // перебирать их сколь угодно долго
+    constexpr int MAX_ALTERNATIVE_COUNT = 10;
+
+    size_t ReadAlternativeCount(const json::Node& node) {
+        const int count = node.AsInt();
+        if (count < 1 || count > MAX_ALTERNATIVE_COUNT) {
+            throw std::runtime_error("Incorrect alternatives count: "s + std::to_string(count));
+        }
+        return static_cast<size_t>(count);
+    }
+
+    // Значение настройки, которое не может быть отрицательным. Отрицательное
+    // число нельзя приводить к size_t: оно превратится в огромное значение
+    size_t ReadCount(const json::Node& node, const std::string& setting_name) {
+        const int count = node.AsInt();
+        if (count < 0) {
+            throw std::runtime_error("Incorrect "s + setting_name + ": "s + std::to_string(count));
+        }
+        return static_cast<size_t>(count);
+    }
+
+    trouter::TransportRouter::GraphModel ReadGraphModel(const json::Node& node) {
+        using GraphModel = trouter::TransportRouter::GraphModel;
+        const std::string& name = node.AsString();
+        if (name == "spans"s) {
+            return GraphModel::SPAN_EDGES;
+        } else if (name == "rides"s) {
+            return GraphModel::RIDE_VERTICES;
+        }
+        throw std::runtime_error("Unknown graph model: "s + name);
+    }
+
+    trouter::TransportRouter::IsochroneOrder ReadIsochroneOrder(const json::Node& node) {
+        using IsochroneOrder = trouter::TransportRouter::IsochroneOrder;
+        const std::string& name = node.AsString();
+        if (name == "time"s) {
+            return IsochroneOrder::BY_TIME;
+        } else if (name == "name"s) {
+            return IsochroneOrder::BY_NAME;
+        }
+        throw std::runtime_error("Unknown sort order: "s + name);
+    }
+
+    trouter::TransportRouter::RouterType ReadRouterType(const json::Node& node) {
+        using RouterType = trouter::TransportRouter::RouterType;
+        const std::string& name = node.AsString();
+        if (name == "all_pairs"s) {
+            return RouterType::ALL_PAIRS;
+        } else if (name == "all_pairs_parallel"s) {
+            return RouterType::ALL_PAIRS_PARALLEL;
+        } else if (name == "all_pairs_compact"s) {
+            return RouterType::ALL_PAIRS_COMPACT;
+        } else if (name == "all_pairs_blocked"s) {
+            return RouterType::ALL_PAIRS_BLOCKED;
+        } else if (name == "dijkstra"s) {
+            return RouterType::DIJKSTRA;
+        } else if (name == "bidirectional"s) {
+            return RouterType::BIDIRECTIONAL;
+        } else if (name == "astar"s) {
+            return RouterType::A_STAR;
+        } else if (name == "alt"s) {
+            return RouterType::ALT;
+        } else if (name == "ch"s) {
+            return RouterType::CONTRACTION_HIERARCHY;
+        } else if (name == "hub_labels"s) {
+            return RouterType::HUB_LABELS;
+        } else if (name == "raptor"s) {
+            return RouterType::RAPTOR;
+        }
+        throw std::runtime_error("Unknown router type: "s + name);
+    }
+
+    // Запрос Route одного оптимального маршрута, без alternatives и transfer_options
+    bool IsSingleRouteRequest(const json::Dict& req_obj) {
+        if (req_obj.at("type"s).AsString() != "Route"s || req_obj.count("alternatives"s) > 0) {
+            return false;
+        }
+        auto it = req_obj.find("transfer_options"s);
+        return it == req_obj.end() || !it->second.AsBool();
+    }
 }
 
 JsonReader::JsonReader(tcat::TransportCatalogue& db, renderer::MapRenderer& map_renderer,
@@ -89,6 +198,22 @@ json::Node JsonReader::ProcessStatRequests(const json::Node& stat_req_node) cons
     json::Builder builder{};
     json::ArrayValueContext array_builder = builder.StartArray();
     const json::Array& req_array = stat_req_node.AsArray();
+
+    // Маршруты запросов Route строятся заранее одним пакетом, чтобы
+    // маршруты из одной начальной остановки находились одним поиском
+    std::vector<std::pair<std::string_view, std::string_view>> route_requests;
+    for (const json::Node& req_node : req_array) {
+        const json::Dict& req_obj = req_node.AsDict();
+        if (IsSingleRouteRequest(req_obj)) {
+            route_requests.emplace_back(req_obj.at("from"s).AsString(), req_obj.at("to"s).AsString());
+        }
+    }
+    std::vector<std::optional<trouter::RouteInfo>> single_routes;
+    if (!route_requests.empty()) {
+        single_routes = handler_.BuildRoutes(route_requests);
+    }
+    size_t next_route = 0;
+
     for (const json::Node& req_node : req_array) {
         const json::Dict& req_obj = req_node.AsDict();
 
@@ -131,27 +256,91 @@ json::Node JsonReader::ProcessStatRequests(const json::Node& stat_req_node) cons
         } else if (type == "Route"s) {
             const std::string& from = req_obj.at("from"s).AsString();
             const std::string& to = req_obj.at("to"s).AsString();
-            std::optional<trouter::RouteInfo> route_info = handler_.BuildRoute(from, to);
-            if (!route_info) {
-                dict_builder.Key("error_message"s).Value("not found"s);
+            if (auto it = req_obj.find("alternatives"s); it != req_obj.end()) {
+                std::vector<trouter::RouteInfo> routes = handler_.BuildAlternativeRoutes(
+                    from, to, ReadAlternativeCount(it->second));
+                if (routes.empty()) {
+                    dict_builder.Key("error_message"s).Value("not found"s);
+                } else {
+                    WriteRoute(dict_builder, routes.front());
+                    json::ArrayValueContext array_builder = dict_builder.Key("alternatives"s).StartArray();
+                    for (size_t i = 1; i < routes.size(); ++i) {
+                        json::DictItemContext route_builder = array_builder.StartDict();
+                        WriteRoute(route_builder, routes[i]);
+                        route_builder.EndDict();
+                    }
+                    array_builder.EndArray();
+                }
+            } else if (auto it = req_obj.find("transfer_options"s);
+                       it != req_obj.end() && it->second.AsBool()) {
+                std::vector<trouter::RouteInfo> routes = handler_.BuildTransferOptions(from, to);
+                if (routes.empty()) {
+                    dict_builder.Key("error_message"s).Value("not found"s);
+                } else {
+                    // Самый быстрый маршрут - с наибольшим числом поездок
+                    WriteRoute(dict_builder, routes.back());
+                    json::ArrayValueContext array_builder =
+                        dict_builder.Key("transfer_options"s).StartArray();
+                    for (const trouter::RouteInfo& route : routes) {
+                        json::DictItemContext route_builder = array_builder.StartDict();
+                        const auto bus_count = std::count_if(route.parts.begin(), route.parts.end(),
+                            [](const trouter::RouteInfo::Item& item) {
+                                return std::holds_alternative<trouter::BusItem>(item);
+                            });
+                        route_builder.Key("bus_count"s).Value(static_cast<int>(bus_count));
+                        WriteRoute(route_builder, route);
+                        route_builder.EndDict();
+                    }
+                    array_builder.EndArray();
+                }
             } else {
-                dict_builder.Key("total_time"s).Value(route_info->total_time);
-                json::ArrayValueContext array_builder = dict_builder.Key("items"s).StartArray();
-                for (trouter::RouteInfo::Item& item : route_info->parts) {
-                    json::DictItemContext item_dict_builder = array_builder.StartDict();
-                    if (std::holds_alternative<trouter::WaitItem>(item)) {
-                        trouter::WaitItem& wait_item = std::get<trouter::WaitItem>(item);
-                        item_dict_builder.Key("type"s).Value("Wait");
-                        item_dict_builder.Key("stop_name"s).Value(std::string(wait_item.stop_name));
-                        item_dict_builder.Key("time"s).Value(wait_item.time);
-                    } else if (std::holds_alternative<trouter::BusItem>(item)) {
-                        trouter::BusItem& bus_item = std::get<trouter::BusItem>(item);
-                        item_dict_builder.Key("type"s).Value("Bus");
-                        item_dict_builder.Key("bus"s).Value(std::string(bus_item.bus_name));
-                        item_dict_builder.Key("span_count"s).Value(bus_item.span_count);
-                        item_dict_builder.Key("time"s).Value(bus_item.time);
+                const std::optional<trouter::RouteInfo>& route_info = single_routes[next_route++];
+                if (!route_info) {
+                    dict_builder.Key("error_message"s).Value("not found"s);
+                } else {
+                    WriteRoute(dict_builder, *route_info);
+                }
+            }
+        } else if (type == "RouteMatrix"s) {
+            std::vector<std::string_view> from;
+            for (const json::Node& name_node : req_obj.at("from"s).AsArray()) {
+                from.push_back(name_node.AsString());
+            }
+            std::vector<std::string_view> to;
+            for (const json::Node& name_node : req_obj.at("to"s).AsArray()) {
+                to.push_back(name_node.AsString());
+            }
+            trouter::TransportRouter::RouteMatrix matrix = handler_.BuildRouteMatrix(from, to);
+            json::ArrayValueContext rows_builder = dict_builder.Key("total_times"s).StartArray();
+            for (const auto& row : matrix) {
+                json::ArrayValueContext row_builder = rows_builder.StartArray();
+                for (const std::optional<double>& total_time : row) {
+                    if (total_time) {
+                        row_builder.Value(*total_time);
+                    } else {
+                        row_builder.Value(nullptr);
                     }
-                    item_dict_builder.EndDict();
+                }
+                row_builder.EndArray();
+            }
+            rows_builder.EndArray();
+        } else if (type == "Isochrone"s) {
+            const std::string& from = req_obj.at("from"s).AsString();
+            double max_time = req_obj.at("max_time"s).AsDouble();
+            auto order = trouter::TransportRouter::IsochroneOrder::BY_TIME;
+            if (auto it = req_obj.find("sort"s); it != req_obj.end()) {
+                order = ReadIsochroneOrder(it->second);
+            }
+            auto isochrone = handler_.BuildIsochrone(from, max_time, order);
+            if (!isochrone) {
+                dict_builder.Key("error_message"s).Value("not found"s);
+            } else {
+                json::ArrayValueContext array_builder = dict_builder.Key("stops"s).StartArray();
+                for (const trouter::IsochroneItem& item : *isochrone) {
+                    array_builder.StartDict()
+                        .Key("stop_name"s).Value(std::string(item.stop_name))
+                        .Key("time"s).Value(item.time)
+                        .EndDict();
                 }
                 array_builder.EndArray();
             }
@@ -200,6 +389,36 @@ void JsonReader::ReadRoutingSettings(const json::Node& routing_settings_node) {
 
     settings.bus_wait_time = obj.at("bus_wait_time"s).AsDouble();
     settings.bus_velocity = obj.at("bus_velocity"s).AsDouble();
+    if (auto it = obj.find("graph_model"s); it != obj.end()) {
+        settings.graph_model = ReadGraphModel(it->second);
+    }
+    if (auto it = obj.find("router_type"s); it != obj.end()) {
+        settings.router_type = ReadRouterType(it->second);
+    }
+    if (auto it = obj.find("heuristic_factor"s); it != obj.end()) {
+        settings.heuristic_factor = it->second.AsDouble();
+    }
+    if (auto it = obj.find("thread_count"s); it != obj.end()) {
+        settings.thread_count = ReadCount(it->second, "thread count"s);
+    }
+    if (auto it = obj.find("landmark_count"s); it != obj.end()) {
+        settings.landmark_count = ReadCount(it->second, "landmark count"s);
+    }
+    if (auto it = obj.find("cache_file"s); it != obj.end()) {
+        settings.cache_file = it->second.AsString();
+    }
+    if (auto it = obj.find("tree_cache_bytes"s); it != obj.end()) {
+        settings.tree_cache_bytes = ReadCount(it->second, "tree cache size"s);
+    }
+    if (auto it = obj.find("fixed_point_weights"s); it != obj.end()) {
+        settings.fixed_point_weights = it->second.AsBool();
+    }
+    if (auto it = obj.find("simplify_graph"s); it != obj.end()) {
+        settings.simplify_graph = it->second.AsBool();
+    }
+    if (auto it = obj.find("prune_parallel_edges"s); it != obj.end()) {
+        settings.prune_parallel_edges = it->second.AsBool();
+    }
 
     transport_router_.SetRoutingSettings(settings);
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+/*
+ * Файл, отображённый в память только для чтения.
+ * Несколько процессов, открывших один файл, используют общие страницы памяти
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace io {
+
+class MappedFile {
+public:
+    // Выбрасывает std::runtime_error, если файл не удалось открыть
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* GetData() const;
+    size_t GetSize() const;
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    // На Windows файл читается в память целиком
+    std::vector<char> buffer_;
+#endif
+};
+
+}  // namespace io
\ No newline at end of file
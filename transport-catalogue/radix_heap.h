@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Поразрядная куча (radix heap) - очередь с приоритетом для беззнаковых
+// целых ключей, в которой ключ добавляемого элемента не меньше ключа
+// последнего извлечённого. Этому условию удовлетворяет очередь алгоритма
+// Дейкстры с неотрицательными весами рёбер.
+// Элемент лежит в корзине по номеру старшего бита, которым его ключ
+// отличается от последнего извлечённого минимума. Каждый элемент
+// перекладывается в корзину с меньшим номером не более digits раз,
+// сравнения элементов друг с другом не нужны.
+// Интерфейс повторяет std::priority_queue с std::greater, top() и pop()
+// неконстантные, так как перекладывают элементы
+template <typename Key, typename Value>
+class RadixHeap {
+    static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key>,
+                  "Radix heap requires unsigned integral keys");
+
+public:
+    using value_type = std::pair<Key, Value>;
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    void push(const value_type& item) {
+        assert(!(item.first < last_key_));
+        buckets_[GetBucketIndex(item.first)].push_back(item);
+        ++size_;
+    }
+
+    const value_type& top() {
+        Refill();
+        return buckets_[0].back();
+    }
+
+    void pop() {
+        Refill();
+        buckets_[0].pop_back();
+        --size_;
+    }
+
+private:
+    static constexpr size_t BUCKET_COUNT = std::numeric_limits<Key>::digits + 1;
+
+    // Номер старшего отличающегося от last_key_ бита, считая с 1.
+    // 0 - ключ равен last_key_
+    size_t GetBucketIndex(Key key) const {
+        const Key diff = key ^ last_key_;
+        if (diff == 0) {
+            return 0;
+        }
+#if defined(__GNUC__)
+        return std::numeric_limits<unsigned long long>::digits
+            - static_cast<size_t>(__builtin_clzll(diff));
+#else
+        size_t index = 0;
+        for (Key rest = diff; rest != 0; rest >>= 1) {
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    // Если нулевая корзина пуста, переложить первую непустую корзину
+    // относительно её минимального ключа. Все её элементы попадут в корзины
+    // с меньшими номерами, минимальный - в нулевую
+    void Refill() {
+        assert(size_ > 0);
+        if (!buckets_[0].empty()) {
+            return;
+        }
+        size_t index = 1;
+        while (buckets_[index].empty()) {
+            ++index;
+        }
+        std::vector<value_type>& bucket = buckets_[index];
+        last_key_ = bucket.front().first;
+        for (const value_type& item : bucket) {
+            if (item.first < last_key_) {
+                last_key_ = item.first;
+            }
+        }
+        for (const value_type& item : bucket) {
+            buckets_[GetBucketIndex(item.first)].push_back(item);
+        }
+        bucket.clear();
+    }
+
+    Key last_key_ = 0;
+    size_t size_ = 0;
+    std::array<std::vector<value_type>, BUCKET_COUNT> buckets_;
+};
+
+}  // namespace graph
\ No newline at end of file
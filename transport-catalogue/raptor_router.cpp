@@ -0,0 +1,275 @@
+#include "raptor_router.h"
+#include "transport_catalogue.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace trouter {
+
+RaptorRouter::RaptorRouter(double bus_wait_time, double bus_velocity)
+    : bus_wait_time_(bus_wait_time)
+    , bus_velocity_(bus_velocity)
+    , route_offsets_{0}
+{
+}
+
+void RaptorRouter::Update(const tcat::TransportCatalogue& db) {
+    // Справочник возвращает остановки и автобусы в порядке добавления,
+    // поэтому новые находятся в конце
+    std::vector<const tcat::Stop*> stops = db.GetAllStops();
+    for (size_t i = stops_.size(); i < stops.size(); ++i) {
+        stop_to_index_.emplace(stops[i], static_cast<uint32_t>(i));
+        stops_.push_back(stops[i]);
+    }
+
+    std::vector<const tcat::Bus*> buses = db.GetAllBuses();
+    for (size_t i = buses_.size(); i < buses.size(); ++i) {
+        AddBus(db, buses[i]);
+    }
+    BuildStopRoutes();
+}
+
+void RaptorRouter::AddBus(const tcat::TransportCatalogue& db, const tcat::Bus* bus) {
+    std::vector<const tcat::Stop*> rounded_stops = bus->GetRoundedStops();
+    if (route_stops_.size() + rounded_stops.size() >= NO_POSITION) {
+        throw std::length_error("Too many stops in bus routes");
+    }
+    for (size_t i = 0; i < rounded_stops.size(); ++i) {
+        route_stops_.push_back(GetStopIndex(rounded_stops[i]));
+        route_segment_distances_.push_back(
+            i > 0 ? db.GetDistance(rounded_stops[i - 1], rounded_stops[i]) : 0.0);
+    }
+    buses_.push_back(bus);
+    route_offsets_.push_back(static_cast<uint32_t>(route_stops_.size()));
+}
+
+void RaptorRouter::BuildStopRoutes() {
+    stop_route_offsets_.assign(stops_.size() + 1, 0);
+    for (const uint32_t stop : route_stops_) {
+        ++stop_route_offsets_[stop + 1];
+    }
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        stop_route_offsets_[stop + 1] += stop_route_offsets_[stop];
+    }
+
+    stop_routes_.resize(route_stops_.size());
+    std::vector<uint32_t> next(stop_route_offsets_.begin(), stop_route_offsets_.end() - 1);
+    for (uint32_t route = 0; route < buses_.size(); ++route) {
+        for (uint32_t position = route_offsets_[route]; position < route_offsets_[route + 1];
+             ++position) {
+            stop_routes_[next[route_stops_[position]]++] = {route, position};
+        }
+    }
+}
+
+uint32_t RaptorRouter::GetStopIndex(const tcat::Stop* stop) const {
+    return stop_to_index_.at(stop);
+}
+
+double RaptorRouter::ComputeTravelTime(double distance) const {
+    constexpr double meter_per_km = 1000.0;
+    constexpr double minutes_in_hour = 60.0;
+    return distance / meter_per_km / bus_velocity_ * minutes_in_hour;
+}
+
+double RaptorRouter::ComputeRideDistance(uint32_t board_position,
+        uint32_t alight_position) const {
+    const uint32_t board_stop = route_stops_[board_position];
+    double distance = 0.0;
+    for (uint32_t position = board_position + 1; position <= alight_position; ++position) {
+        if (route_stops_[position] != board_stop) {
+            distance += route_segment_distances_[position];
+        }
+    }
+    return distance;
+}
+
+size_t RaptorRouter::Search(SearchBuffers& buffers, uint32_t from, uint32_t target,
+        double time_limit, bool record_labels) const {
+    const size_t stop_count = stops_.size();
+    buffers.best_times.assign(stop_count, NO_TIME);
+    buffers.round_times.assign(stop_count, NO_TIME);
+    buffers.is_marked.assign(stop_count, false);
+    buffers.scan_starts.assign(buses_.size(), NO_POSITION);
+    buffers.marked_stops.clear();
+
+    buffers.best_times[from] = 0.0;
+    buffers.round_times[from] = 0.0;
+    buffers.marked_stops.push_back(from);
+
+    size_t round = 0;
+    while (!buffers.marked_stops.empty()) {
+        ++round;
+
+        // Маршруты через отмеченные остановки просматриваются с первой из них
+        buffers.scanned_routes.clear();
+        for (const uint32_t stop : buffers.marked_stops) {
+            buffers.is_marked[stop] = false;
+            for (uint32_t i = stop_route_offsets_[stop]; i < stop_route_offsets_[stop + 1]; ++i) {
+                const auto [route, position] = stop_routes_[i];
+                uint32_t& scan_start = buffers.scan_starts[route];
+                if (scan_start == NO_POSITION) {
+                    buffers.scanned_routes.push_back(route);
+                }
+                scan_start = std::min(scan_start, position);
+            }
+        }
+        buffers.marked_stops.clear();
+
+        if (record_labels) {
+            if (buffers.labels.size() <= round) {
+                buffers.labels.resize(round + 1);
+            }
+            buffers.labels[round].assign(stop_count, Label{NO_TIME, 0, 0, 0});
+        }
+
+        for (const uint32_t route : buffers.scanned_routes) {
+            const uint32_t end = route_offsets_[route + 1];
+            // Время отправления с остановки посадки после ожидания автобуса
+            double departure_time = NO_TIME;
+            uint32_t board_position = NO_POSITION;
+            // Расстояние от остановки посадки, как в ComputeRideDistance
+            double ride_distance = 0.0;
+            for (uint32_t position = std::exchange(buffers.scan_starts[route], NO_POSITION);
+                 position < end; ++position) {
+                const uint32_t stop = route_stops_[position];
+                double time = NO_TIME;
+                if (board_position != NO_POSITION && stop == route_stops_[board_position]) {
+                    // Автобус вернулся на остановку посадки. Если с посадки пройдено
+                    // ненулевое расстояние, поездка отсюда короче. При равном
+                    // расстоянии остаётся более ранняя посадка, как в графе
+                    if (ride_distance > 0.0) {
+                        board_position = position;
+                        ride_distance = 0.0;
+                    }
+                    continue;
+                }
+                if (board_position != NO_POSITION) {
+                    ride_distance += route_segment_distances_[position];
+                    time = departure_time + ComputeTravelTime(ride_distance);
+                    const double bound = target == NO_STOP
+                        ? buffers.best_times[stop]
+                        : std::min(buffers.best_times[stop], buffers.best_times[target]);
+                    if (time < bound && time <= time_limit) {
+                        buffers.best_times[stop] = time;
+                        if (record_labels) {
+                            buffers.labels[round][stop] = {time, route, board_position, position};
+                        }
+                        if (!buffers.is_marked[stop]) {
+                            buffers.is_marked[stop] = true;
+                            buffers.marked_stops.push_back(stop);
+                        }
+                    }
+                }
+                // Пересесть на этот автобус здесь, если так получится раньше
+                if (buffers.round_times[stop] != NO_TIME) {
+                    const double board_time = buffers.round_times[stop] + bus_wait_time_;
+                    if (board_position == NO_POSITION || board_time < time) {
+                        departure_time = board_time;
+                        board_position = position;
+                        ride_distance = 0.0;
+                    }
+                }
+            }
+        }
+
+        for (const uint32_t stop : buffers.marked_stops) {
+            buffers.round_times[stop] = buffers.best_times[stop];
+        }
+    }
+    // Последний раунд ничего не улучшил
+    return round - 1;
+}
+
+RaptorRouter::Journey RaptorRouter::MakeJourney(const SearchBuffers& buffers, uint32_t to,
+        size_t round) const {
+    Journey journey;
+    journey.total_time = round == 0 ? 0.0 : buffers.labels[round][to].time;
+    uint32_t stop = to;
+    while (round > 0) {
+        const Label& label = buffers.labels[round][stop];
+        stop = route_stops_[label.board_position];
+        journey.legs.push_back({stops_[stop], buses_[label.route]->name,
+            static_cast<int>(label.alight_position - label.board_position),
+            ComputeTravelTime(ComputeRideDistance(label.board_position,
+                                                  label.alight_position))});
+        // Посадка была по лучшему времени на конец предыдущего раунда,
+        // оно получено в последнем раунде, улучшившем время остановки
+        --round;
+        while (round > 0 && buffers.labels[round][stop].time == NO_TIME) {
+            --round;
+        }
+    }
+    std::reverse(journey.legs.begin(), journey.legs.end());
+    return journey;
+}
+
+std::optional<RaptorRouter::Journey> RaptorRouter::BuildRoute(const tcat::Stop* from,
+        const tcat::Stop* to) const {
+    const uint32_t from_index = GetStopIndex(from);
+    const uint32_t to_index = GetStopIndex(to);
+    SearchBuffers& buffers = GetBuffers();
+    const size_t round_count = Search(buffers, from_index, to_index, NO_TIME, true);
+    if (buffers.best_times[to_index] == NO_TIME) {
+        return std::nullopt;
+    }
+    // Лучшее время найдено в последнем раунде, улучшившем время остановки to
+    size_t round = round_count;
+    while (round > 0 && buffers.labels[round][to_index].time == NO_TIME) {
+        --round;
+    }
+    return MakeJourney(buffers, to_index, round);
+}
+
+std::vector<RaptorRouter::Journey> RaptorRouter::BuildTransferOptions(const tcat::Stop* from,
+        const tcat::Stop* to) const {
+    const uint32_t from_index = GetStopIndex(from);
+    const uint32_t to_index = GetStopIndex(to);
+    SearchBuffers& buffers = GetBuffers();
+    const size_t round_count = Search(buffers, from_index, to_index, NO_TIME, true);
+
+    std::vector<Journey> result;
+    if (from_index == to_index) {
+        result.push_back(MakeJourney(buffers, to_index, 0));
+        return result;
+    }
+    // Время остановки to улучшается только в раундах с оптимальными по Парето маршрутами
+    for (size_t round = 1; round <= round_count; ++round) {
+        if (buffers.labels[round][to_index].time != NO_TIME) {
+            result.push_back(MakeJourney(buffers, to_index, round));
+        }
+    }
+    return result;
+}
+
+std::vector<std::optional<double>> RaptorRouter::ComputeTimes(const tcat::Stop* from,
+        const std::vector<const tcat::Stop*>& targets) const {
+    SearchBuffers& buffers = GetBuffers();
+    Search(buffers, GetStopIndex(from), NO_STOP, NO_TIME, false);
+    std::vector<std::optional<double>> result;
+    result.reserve(targets.size());
+    for (const tcat::Stop* stop : targets) {
+        const double time = buffers.best_times[GetStopIndex(stop)];
+        result.push_back(time == NO_TIME ? std::nullopt : std::optional<double>(time));
+    }
+    return result;
+}
+
+std::vector<std::pair<const tcat::Stop*, double>> RaptorRouter::FindReachableStops(
+        const tcat::Stop* from, double max_time) const {
+    SearchBuffers& buffers = GetBuffers();
+    Search(buffers, GetStopIndex(from), NO_STOP, max_time, false);
+    std::vector<std::pair<const tcat::Stop*, double>> result;
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        if (buffers.best_times[stop] != NO_TIME) {
+            result.emplace_back(stops_[stop], buffers.best_times[stop]);
+        }
+    }
+    std::stable_sort(result.begin(), result.end(),
+        [](const auto& lhs, const auto& rhs) {
+            return lhs.second < rhs.second;
+        });
+    return result;
+}
+
+}  // namespace trouter
\ No newline at end of file
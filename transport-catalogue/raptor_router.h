@@ -0,0 +1,148 @@
+#pragma once
+
+/*
+ * Поиск маршрутов алгоритмом RAPTOR (Round-bAsed Public Transit Optimized Router).
+ * Работает напрямую по спискам остановок автобусов, граф не строится
+ */
+
+#include "domain.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tcat { class TransportCatalogue; }
+
+namespace trouter {
+
+// Маршрут автобуса - непрерывный участок общего массива остановок.
+// В k-м раунде просматриваются маршруты, проходящие через остановки,
+// время прибытия на которые улучшилось в предыдущем раунде, и находится
+// лучшее время прибытия не более чем с k поездками.
+// Каждая посадка стоит bus_wait_time минут ожидания, время поездки считается
+// по дорожному расстоянию от остановки посадки, как в графе TransportRouter
+class RaptorRouter {
+public:
+    // Поездка на одном автобусе
+    struct Leg {
+        // Остановка посадки
+        const tcat::Stop* stop;
+        std::string_view bus_name;
+        // Количество пройденных промежутков маршрута
+        int span_count;
+        // Время поездки без ожидания, в минутах
+        double time;
+    };
+
+    struct Journey {
+        // Суммарное время с ожиданием, в минутах
+        double total_time = 0.0;
+        std::vector<Leg> legs;
+    };
+
+    RaptorRouter(double bus_wait_time, double bus_velocity);
+
+    // Добавить остановки и автобусы справочника, которых ещё нет
+    void Update(const tcat::TransportCatalogue& db);
+
+    std::optional<Journey> BuildRoute(const tcat::Stop* from, const tcat::Stop* to) const;
+
+    // Оптимальные по Парето маршруты по времени и числу поездок в порядке
+    // возрастания числа поездок. Каждый следующий маршрут быстрее предыдущего
+    std::vector<Journey> BuildTransferOptions(const tcat::Stop* from, const tcat::Stop* to) const;
+
+    // Время в пути из from до каждой из остановок targets,
+    // std::nullopt - маршрута нет
+    std::vector<std::optional<double>> ComputeTimes(const tcat::Stop* from,
+            const std::vector<const tcat::Stop*>& targets) const;
+
+    // Остановки, до которых можно доехать не более чем за max_time минут,
+    // в порядке возрастания времени
+    std::vector<std::pair<const tcat::Stop*, double>> FindReachableStops(
+            const tcat::Stop* from, double max_time) const;
+
+private:
+    static constexpr double NO_TIME = std::numeric_limits<double>::infinity();
+    static constexpr uint32_t NO_STOP = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t NO_POSITION = std::numeric_limits<uint32_t>::max();
+
+    // Лучшее прибытие на остановку в раунде
+    struct Label {
+        double time;
+        uint32_t route;
+        // Позиции посадки и высадки в массиве route_stops_
+        uint32_t board_position;
+        uint32_t alight_position;
+    };
+
+    // Проход маршрута через остановку
+    struct StopRoute {
+        uint32_t route;
+        uint32_t position;
+    };
+
+    struct SearchBuffers {
+        std::vector<double> best_times;
+        // Лучшие времена на конец предыдущего раунда, по ним делается посадка
+        std::vector<double> round_times;
+        std::vector<uint32_t> marked_stops;
+        std::vector<bool> is_marked;
+        // Первая позиция маршрута, с которой его нужно просмотреть в раунде
+        std::vector<uint32_t> scan_starts;
+        std::vector<uint32_t> scanned_routes;
+        // Метки остановок по раундам, заполняются при record_labels
+        std::vector<std::vector<Label>> labels;
+    };
+
+    static SearchBuffers& GetBuffers() {
+        thread_local SearchBuffers buffers;
+        return buffers;
+    }
+
+    void AddBus(const tcat::TransportCatalogue& db, const tcat::Bus* bus);
+
+    // Заполнить списки маршрутов, проходящих через каждую остановку
+    void BuildStopRoutes();
+
+    uint32_t GetStopIndex(const tcat::Stop* stop) const;
+
+    double ComputeTravelTime(double distance) const;
+
+    // Расстояние поездки от позиции посадки до позиции высадки, в метрах.
+    // Как и в рёбрах графа TransportRouter, промежутки, которые заканчиваются
+    // на остановке посадки, не учитываются
+    double ComputeRideDistance(uint32_t board_position, uint32_t alight_position) const;
+
+    // Поиск из остановки from. Времена больше time_limit и не лучше времени
+    // до target отбрасываются. Возвращает число выполненных раундов
+    size_t Search(SearchBuffers& buffers, uint32_t from, uint32_t target, double time_limit,
+                  bool record_labels) const;
+
+    // Маршрут до остановки to, найденный в раунде round
+    Journey MakeJourney(const SearchBuffers& buffers, uint32_t to, size_t round) const;
+
+    double bus_wait_time_;
+    double bus_velocity_;
+
+    std::vector<const tcat::Stop*> stops_;
+    std::unordered_map<const tcat::Stop*, uint32_t> stop_to_index_;
+
+    // Остановки маршрута route занимают [route_offsets_[route], route_offsets_[route + 1])
+    // в route_stops_. В route_segment_distances_ - расстояние от предыдущей
+    // остановки маршрута, в метрах
+    std::vector<const tcat::Bus*> buses_;
+    std::vector<uint32_t> route_offsets_;
+    std::vector<uint32_t> route_stops_;
+    std::vector<double> route_segment_distances_;
+
+    // Проходы маршрутов через остановку stop занимают
+    // [stop_route_offsets_[stop], stop_route_offsets_[stop + 1]) в stop_routes_
+    std::vector<uint32_t> stop_route_offsets_;
+    std::vector<StopRoute> stop_routes_;
+};
+
+}  // namespace trouter
\ No newline at end of file
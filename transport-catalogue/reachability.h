@@ -0,0 +1,196 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// Компоненты сильной связности графа и достижимость между ними.
+// Компоненты нумеруются алгоритмом Тарьяна в обратном топологическом порядке
+// графа конденсации: ребро ведёт из компоненты в компоненту с номером не больше.
+// Если граф конденсации небольшой, для каждой компоненты хранится битовое
+// множество достижимых из неё компонент (O(C^2 / 8) байт), и на вопрос
+// о достижимости отвечает O(1) проверка без поиска.
+// Граф должен быть заморожен (DirectedWeightedGraph::Freeze)
+template <typename Weight>
+class ReachabilityIndex {
+public:
+    // Предел памяти таблицы достижимости компонент. Для большего числа
+    // компонент проверяется только топологический порядок
+    static constexpr size_t MAX_CLOSURE_BYTES = size_t{16} << 20;
+
+    explicit ReachabilityIndex(const DirectedWeightedGraph<Weight>& graph);
+
+    size_t GetComponentCount() const {
+        return component_count_;
+    }
+
+    size_t GetComponent(VertexId vertex) const {
+        return components_.at(vertex);
+    }
+
+    bool HasClosure() const {
+        return !closure_.empty();
+    }
+
+    // false - пути из from в to точно нет. true - путь есть, а если
+    // таблица достижимости не построена, путь может быть
+    bool IsReachable(VertexId from, VertexId to) const;
+
+private:
+    void FindComponents(const DirectedWeightedGraph<Weight>& graph);
+
+    void BuildClosure(const DirectedWeightedGraph<Weight>& graph);
+
+    std::vector<size_t> components_;
+    size_t component_count_ = 0;
+    // Компоненты, достижимые из компоненты c, - биты
+    // [c * words_per_component_, (c + 1) * words_per_component_)
+    size_t words_per_component_ = 0;
+    std::vector<uint64_t> closure_;
+};
+
+template <typename Weight>
+ReachabilityIndex<Weight>::ReachabilityIndex(const DirectedWeightedGraph<Weight>& graph) {
+    if (!graph.IsFrozen()) {
+        throw std::logic_error("Graph should be frozen");
+    }
+    FindComponents(graph);
+    words_per_component_ = (component_count_ + 63) / 64;
+    if (component_count_ * words_per_component_ * sizeof(uint64_t) <= MAX_CLOSURE_BYTES) {
+        BuildClosure(graph);
+    }
+}
+
+template <typename Weight>
+void ReachabilityIndex<Weight>::FindComponents(const DirectedWeightedGraph<Weight>& graph) {
+    constexpr size_t NO_INDEX = std::numeric_limits<size_t>::max();
+    const size_t vertex_count = graph.GetVertexCount();
+    components_.assign(vertex_count, NO_INDEX);
+    component_count_ = 0;
+
+    // Алгоритм Тарьяна без рекурсии: стек вызовов хранит вершину
+    // и номер следующего просматриваемого ребра
+    struct Frame {
+        VertexId vertex;
+        size_t next_arc;
+    };
+    std::vector<size_t> indexes(vertex_count, NO_INDEX);
+    std::vector<size_t> lowlinks(vertex_count, 0);
+    std::vector<bool> is_on_stack(vertex_count, false);
+    std::vector<VertexId> stack;
+    std::vector<Frame> frames;
+    size_t next_index = 0;
+
+    const auto visit = [&](VertexId vertex) {
+        indexes[vertex] = lowlinks[vertex] = next_index++;
+        stack.push_back(vertex);
+        is_on_stack[vertex] = true;
+        frames.push_back({vertex, 0});
+    };
+
+    for (VertexId root = 0; root < vertex_count; ++root) {
+        if (indexes[root] != NO_INDEX) {
+            continue;
+        }
+        visit(root);
+        while (!frames.empty()) {
+            const VertexId vertex = frames.back().vertex;
+            const auto arcs = graph.GetOutgoingArcs(vertex);
+            const size_t arc_count = static_cast<size_t>(arcs.end() - arcs.begin());
+            if (frames.back().next_arc < arc_count) {
+                const VertexId next = arcs.begin()[frames.back().next_arc++].vertex;
+                if (indexes[next] == NO_INDEX) {
+                    visit(next);
+                } else if (is_on_stack[next]) {
+                    lowlinks[vertex] = std::min(lowlinks[vertex], indexes[next]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                const VertexId parent = frames.back().vertex;
+                lowlinks[parent] = std::min(lowlinks[parent], lowlinks[vertex]);
+            }
+            if (lowlinks[vertex] == indexes[vertex]) {
+                // Вершина - корень компоненты, компонента лежит на стеке над ней
+                VertexId member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    is_on_stack[member] = false;
+                    components_[member] = component_count_;
+                } while (member != vertex);
+                ++component_count_;
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ReachabilityIndex<Weight>::BuildClosure(const DirectedWeightedGraph<Weight>& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+
+    // Вершины по компонентам
+    std::vector<size_t> offsets(component_count_ + 1, 0);
+    for (const size_t component : components_) {
+        ++offsets[component + 1];
+    }
+    for (size_t component = 0; component < component_count_; ++component) {
+        offsets[component + 1] += offsets[component];
+    }
+    std::vector<VertexId> vertices(vertex_count);
+    {
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            vertices[next[components_[vertex]]++] = vertex;
+        }
+    }
+
+    // Компоненты с меньшими номерами уже обработаны: рёбра ведут только в них
+    constexpr size_t NO_COMPONENT = std::numeric_limits<size_t>::max();
+    std::vector<size_t> last_source(component_count_, NO_COMPONENT);
+    closure_.assign(component_count_ * words_per_component_, 0);
+    for (size_t component = 0; component < component_count_; ++component) {
+        uint64_t* reachable = closure_.data() + component * words_per_component_;
+        reachable[component / 64] |= uint64_t{1} << (component % 64);
+        for (size_t i = offsets[component]; i < offsets[component + 1]; ++i) {
+            for (const auto& arc : graph.GetOutgoingArcs(vertices[i])) {
+                const size_t next = components_[arc.vertex];
+                if (next == component || last_source[next] == component) {
+                    continue;
+                }
+                last_source[next] = component;
+                const uint64_t* next_reachable = closure_.data() + next * words_per_component_;
+                for (size_t word = 0; word < words_per_component_; ++word) {
+                    reachable[word] |= next_reachable[word];
+                }
+            }
+        }
+    }
+}
+
+template <typename Weight>
+bool ReachabilityIndex<Weight>::IsReachable(VertexId from, VertexId to) const {
+    const size_t from_component = components_.at(from);
+    const size_t to_component = components_.at(to);
+    if (from_component == to_component) {
+        return true;
+    }
+    if (from_component < to_component) {
+        return false;
+    }
+    if (closure_.empty()) {
+        return true;
+    }
+    const uint64_t word = closure_[from_component * words_per_component_ + to_component / 64];
+    return (word >> (to_component % 64)) & 1;
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -57,12 +57,75 @@ svg::Document RequestHandler::RenderMap() const {
 
 std::optional<trouter::RouteInfo>
         RequestHandler::BuildRoute(std::string_view from, std::string_view to) {
-    if (!transport_router_.IsRouterInitialized()) {
-        transport_router_.InitRouter(db_);
-    }
+    PrepareRouter();
     const tcat::Stop* from_stop = db_.FindStop(from);
     const tcat::Stop* to_stop = db_.FindStop(to);
 
     return transport_router_.BuildRoute(from_stop, to_stop);
 }
+
+std::vector<std::optional<trouter::RouteInfo>> RequestHandler::BuildRoutes(
+        const std::vector<std::pair<std::string_view, std::string_view>>& requests) {
+    PrepareRouter();
+    std::vector<trouter::TransportRouter::StopPair> stop_pairs;
+    stop_pairs.reserve(requests.size());
+    for (const auto& [from, to] : requests) {
+        stop_pairs.emplace_back(db_.FindStop(from), db_.FindStop(to));
+    }
+
+    return transport_router_.BuildRoutes(stop_pairs);
+}
+
+std::vector<trouter::RouteInfo> RequestHandler::BuildAlternativeRoutes(std::string_view from,
+        std::string_view to, size_t alternative_count) {
+    PrepareRouter();
+    const tcat::Stop* from_stop = db_.FindStop(from);
+    const tcat::Stop* to_stop = db_.FindStop(to);
+
+    return transport_router_.BuildAlternativeRoutes(from_stop, to_stop, alternative_count + 1);
+}
+
+std::vector<trouter::RouteInfo> RequestHandler::BuildTransferOptions(std::string_view from,
+        std::string_view to) {
+    PrepareRouter();
+    const tcat::Stop* from_stop = db_.FindStop(from);
+    const tcat::Stop* to_stop = db_.FindStop(to);
+
+    return transport_router_.BuildTransferOptions(from_stop, to_stop);
+}
+
+trouter::TransportRouter::RouteMatrix RequestHandler::BuildRouteMatrix(
+        const std::vector<std::string_view>& from, const std::vector<std::string_view>& to) {
+    PrepareRouter();
+    std::vector<const tcat::Stop*> from_stops;
+    for (std::string_view name : from) {
+        from_stops.push_back(db_.FindStop(name));
+    }
+    std::vector<const tcat::Stop*> to_stops;
+    for (std::string_view name : to) {
+        to_stops.push_back(db_.FindStop(name));
+    }
+
+    return transport_router_.BuildRouteMatrix(from_stops, to_stops);
+}
+
+std::optional<std::vector<trouter::IsochroneItem>> RequestHandler::BuildIsochrone(
+        std::string_view from, double max_time, trouter::TransportRouter::IsochroneOrder order) {
+    const tcat::Stop* from_stop = db_.FindStop(from);
+    if (!from_stop) {
+        return std::nullopt;
+    }
+    PrepareRouter();
+
+    return transport_router_.BuildIsochrone(from_stop, max_time, order);
+}
+
+void RequestHandler::PrepareRouter() {
+    if (!transport_router_.IsRouterInitialized()) {
+        transport_router_.InitRouter(db_);
+    } else {
+        // Учесть остановки и автобусы, добавленные после первого запроса
+        transport_router_.UpdateRouter(db_);
+    }
+}
 }
\ No newline at end of file
@@ -11,6 +11,8 @@
 #include <optional>
 #include <set>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 namespace tcat { class TransportCatalogue; }
 namespace renderer { class MapRenderer; }
@@ -46,7 +48,34 @@ public:
     // Построить маршрут (запрос Route)
     std::optional<trouter::RouteInfo> BuildRoute(std::string_view from, std::string_view to);
 
+    // Построить маршруты для пар остановок (from, to), результаты в том же порядке.
+    // Маршруты из одной начальной остановки строятся одним поиском
+    std::vector<std::optional<trouter::RouteInfo>> BuildRoutes(
+            const std::vector<std::pair<std::string_view, std::string_view>>& requests);
+
+    // Построить оптимальный маршрут и не более alternative_count альтернативных
+    // (запрос Route с ключом alternatives). Пустой результат - маршрут не найден
+    std::vector<trouter::RouteInfo> BuildAlternativeRoutes(std::string_view from,
+            std::string_view to, size_t alternative_count);
+
+    // Построить маршруты, оптимальные по времени и числу поездок на автобусах
+    // (запрос Route с ключом transfer_options). Пустой результат - маршрут не найден
+    std::vector<trouter::RouteInfo> BuildTransferOptions(std::string_view from,
+            std::string_view to);
+
+    // Построить матрицу времени в пути между наборами остановок (запрос RouteMatrix)
+    trouter::TransportRouter::RouteMatrix BuildRouteMatrix(
+            const std::vector<std::string_view>& from, const std::vector<std::string_view>& to);
+
+    // Найти остановки, достижимые за заданное время (запрос Isochrone).
+    // Если начальной остановки нет в справочнике, возвращает std::nullopt
+    std::optional<std::vector<trouter::IsochroneItem>> BuildIsochrone(std::string_view from,
+            double max_time, trouter::TransportRouter::IsochroneOrder order);
+
 private:
+    // Построить маршрутизатор или добавить в него новые остановки и автобусы
+    void PrepareRouter();
+
     const tcat::TransportCatalogue& db_;
     const renderer::MapRenderer& map_renderer_;
     trouter::TransportRouter& transport_router_;
@@ -1,13 +1,17 @@
 #pragma once
 
 #include "graph.h"
+#include "router_base.h"
 
 #include <algorithm>
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
 #include <iterator>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -16,19 +20,30 @@ namespace graph {
 
 // Поиск кратчайшего пути во взвешенном ориентированном графе
 template <typename Weight>
-class Router {
+class Router : public RouterBase<Weight> {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
+    using typename RouterBase<Weight>::RouteInfo;
+
     explicit Router(const Graph& graph);
 
-    struct RouteInfo {
-        Weight weight;
-        std::vector<EdgeId> edges;
-    };
+    // Заполнить таблицу тем же алгоритмом Флойда-Уоршелла в thread_count потоках.
+    // На шаге с промежуточной вершиной k строка k не меняется, поэтому строки
+    // улучшаются в разных потоках независимо, а шаги идут по порядку. Каждая
+    // ячейка улучшается в том же порядке, что и в одном потоке, и таблица,
+    // в том числе последние рёбра путей равного веса, совпадает с ней.
+    // При thread_count == 0 число потоков равно числу ядер процессора
+    Router(const Graph& graph, size_t thread_count);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Дополнить таблицу новыми вершинами и улучшить маршруты через новые рёбра
+    bool Update(EdgeId first_new_edge) override;
 
 private:
     struct RouteInternalData {
@@ -64,18 +79,46 @@ private:
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
+    // Улучшить маршруты, которые становятся короче при проезде по ребру edge_id.
+    // Строки вершин, до конца ребра из которых ребро путь не сокращает, не меняются
+    void RelaxRoutesInternalDataThroughEdge(size_t vertex_count, EdgeId edge_id) {
+        const auto& edge = graph_.GetEdgeUnchecked(edge_id);
+        const auto& routes_to = routes_internal_data_[edge.to];
         for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                    }
+            auto& routes_from = routes_internal_data_[vertex_from];
+            if (!routes_from[edge.from]) {
+                continue;
+            }
+            const Weight weight_through = routes_from[edge.from]->weight + edge.weight;
+            if (routes_from[edge.to] && !(weight_through < routes_from[edge.to]->weight)) {
+                continue;
+            }
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                if (const auto& route_to = routes_to[vertex_to]) {
+                    RelaxRoute(vertex_from, vertex_to, {weight_through, edge_id}, *route_to);
+                }
+            }
+        }
+    }
+
+    // Улучшить строку vertex_from через вершину vertex_through
+    void RelaxRowThroughVertex(size_t vertex_count, VertexId vertex_from,
+                               VertexId vertex_through) {
+        if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
+            for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
+                if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
+                    RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
                 }
             }
         }
     }
 
+    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
+        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+            RelaxRowThroughVertex(vertex_count, vertex_from, vertex_through);
+        }
+    }
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
     RoutesInternalData routes_internal_data_;
@@ -95,6 +138,102 @@ Router<Weight>::Router(const Graph& graph)
     }
 }
 
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, size_t thread_count)
+    : graph_(graph)
+    , routes_internal_data_(graph.GetVertexCount(),
+                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+{
+    InitializeRoutesInternalData(graph);
+
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t vertex_count = graph.GetVertexCount();
+    thread_count = std::min(thread_count, std::max<size_t>(vertex_count, 1));
+    if (thread_count == 1) {
+        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+        }
+        return;
+    }
+
+    // Поток index улучшает строки index, index + thread_count, ... и ждёт
+    // остальные потоки перед переходом к следующей промежуточной вершине
+    std::mutex mutex;
+    std::condition_variable step_done;
+    size_t waiting_count = 0;
+    size_t step = 0;
+    auto wait_others = [&] {
+        std::unique_lock lock(mutex);
+        if (++waiting_count == thread_count) {
+            waiting_count = 0;
+            ++step;
+            step_done.notify_all();
+        } else {
+            const size_t current_step = step;
+            step_done.wait(lock, [&] { return step != current_step; });
+        }
+    };
+    auto worker = [this, &wait_others, vertex_count, thread_count](size_t index) {
+        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
+            for (VertexId vertex_from = index; vertex_from < vertex_count;
+                 vertex_from += thread_count) {
+                RelaxRowThroughVertex(vertex_count, vertex_from, vertex_through);
+            }
+            wait_others();
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+template <typename Weight>
+bool Router<Weight>::Update(EdgeId first_new_edge) {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t old_vertex_count = routes_internal_data_.size();
+    for (auto& routes : routes_internal_data_) {
+        routes.resize(vertex_count);
+    }
+    routes_internal_data_.resize(vertex_count,
+                                 std::vector<std::optional<RouteInternalData>>(vertex_count));
+    for (VertexId vertex = old_vertex_count; vertex < vertex_count; ++vertex) {
+        routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    }
+
+    const size_t edge_count = graph_.GetEdgeCount();
+    for (EdgeId edge_id = first_new_edge; edge_id < edge_count; ++edge_id) {
+        if (graph_.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        RelaxRoutesInternalDataThroughEdge(vertex_count, edge_id);
+    }
+    return true;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> Router<Weight>::ComputeWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    const auto& routes = routes_internal_data_.at(from);
+    std::vector<std::optional<Weight>> weights;
+    weights.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (const auto& route = routes.at(to)) {
+            weights.push_back(route->weight);
+        } else {
+            weights.push_back(std::nullopt);
+        }
+    }
+    return weights;
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
@@ -106,7 +245,7 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     std::vector<EdgeId> edges;
     for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
          edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+         edge_id = routes_internal_data_[from][graph_.GetEdgeUnchecked(*edge_id).from]->prev_edge)
     {
         edges.push_back(*edge_id);
     }
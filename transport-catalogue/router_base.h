@@ -0,0 +1,48 @@
+#pragma once
+
+#include "graph.h"
+
+#include <optional>
+#include <vector>
+
+namespace graph {
+
+// Общий интерфейс алгоритмов поиска кратчайшего пути
+template <typename Weight>
+class RouterBase {
+public:
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    virtual ~RouterBase() = default;
+
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    // Веса кратчайших путей из from во все вершины targets, без восстановления путей.
+    // По умолчанию строится маршрут до каждой вершины
+    virtual std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<Weight>> weights;
+        weights.reserve(targets.size());
+        for (const VertexId to : targets) {
+            if (auto route = BuildRoute(from, to)) {
+                weights.push_back(route->weight);
+            } else {
+                weights.push_back(std::nullopt);
+            }
+        }
+        return weights;
+    }
+
+    // Учесть вершины и рёбра, добавленные в граф после создания маршрутизатора.
+    // Новые рёбра имеют номера от first_new_edge. Возвращает false, если
+    // маршрутизатор нужно построить заново. Поиску на каждый запрос
+    // обновлять нечего
+    virtual bool Update(EdgeId /*first_new_edge*/) {
+        return true;
+    }
+};
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Кратчайшие пути из вершины root во все вершины графа
+template <typename Weight>
+class ShortestPathTree {
+public:
+    using RouteInfo = typename RouterBase<Weight>::RouteInfo;
+
+    // Построить дерево поиском Дейкстры. Граф должен быть заморожен
+    ShortestPathTree(const DirectedWeightedGraph<Weight>& graph, VertexId root);
+
+    VertexId GetRoot() const {
+        return root_;
+    }
+
+    // Путь из root в to
+    std::optional<RouteInfo> BuildRoute(const DirectedWeightedGraph<Weight>& graph,
+                                        VertexId to) const;
+
+    // Память, занимаемая деревом
+    size_t GetByteSize() const {
+        return weights_.size() * (sizeof(Weight) + sizeof(EdgeId)) + sizeof(*this);
+    }
+
+    // Память дерева для графа из vertex_count вершин
+    static size_t ComputeByteSize(size_t vertex_count) {
+        return vertex_count * (sizeof(Weight) + sizeof(EdgeId)) + sizeof(ShortestPathTree);
+    }
+
+private:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+    bool IsReached(VertexId vertex) const {
+        return vertex == root_ || prev_edges_[vertex] != NO_EDGE;
+    }
+
+    VertexId root_;
+    std::vector<Weight> weights_;
+    // Последнее ребро пути, NO_EDGE для root и недостижимых вершин
+    std::vector<EdgeId> prev_edges_;
+};
+
+template <typename Weight>
+ShortestPathTree<Weight>::ShortestPathTree(const DirectedWeightedGraph<Weight>& graph,
+                                           VertexId root)
+    : root_(root)
+    , weights_(graph.GetVertexCount(), Weight{})
+    , prev_edges_(graph.GetVertexCount(), NO_EDGE)
+{
+    if (root >= weights_.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    // Поиск тот же, что у DijkstraRouter, поэтому при равном весе
+    // выбираются те же пути
+    thread_local detail::SearchBuffers<Weight> buffers;
+    detail::RunDijkstra(graph, buffers, root, true,
+        [this](VertexId vertex, Weight weight, std::optional<EdgeId> prev_edge) {
+            weights_[vertex] = weight;
+            prev_edges_[vertex] = prev_edge.value_or(NO_EDGE);
+            return detail::SettleAction::RELAX;
+        });
+}
+
+template <typename Weight>
+std::optional<typename ShortestPathTree<Weight>::RouteInfo>
+ShortestPathTree<Weight>::BuildRoute(const DirectedWeightedGraph<Weight>& graph,
+                                     VertexId to) const {
+    if (to >= weights_.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (!IsReached(to)) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edges_[to];
+         edge_id != NO_EDGE;
+         edge_id = prev_edges_[graph.GetEdgeUnchecked(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return RouteInfo{weights_[to], std::move(edges)};
+}
+
+// Кэш деревьев кратчайших путей для недавно использованных начальных вершин.
+// Суммарный размер деревьев не превышает max_bytes, при переполнении
+// удаляются деревья, которые дольше всего не использовались
+template <typename Weight>
+class ShortestPathTreeCache {
+public:
+    using Tree = ShortestPathTree<Weight>;
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t tree_count = 0;
+        size_t byte_size = 0;
+    };
+
+    explicit ShortestPathTreeCache(size_t max_bytes)
+        : max_bytes_(max_bytes) {
+    }
+
+    // Дерево для вершины root. Если дерево не помещается в кэш,
+    // возвращается nullptr
+    std::shared_ptr<const Tree> GetTree(const DirectedWeightedGraph<Weight>& graph,
+                                        VertexId root);
+
+    // Удалить все деревья, например после изменения графа
+    void Clear();
+
+    Stats GetStats() const;
+
+private:
+    using TreeList = std::list<std::shared_ptr<const Tree>>;
+
+    size_t max_bytes_;
+    size_t byte_size_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    // Деревья от недавно использованных к давно использованным
+    TreeList trees_;
+    std::unordered_map<VertexId, typename TreeList::iterator> root_to_tree_;
+    mutable std::mutex mutex_;
+};
+
+template <typename Weight>
+std::shared_ptr<const typename ShortestPathTreeCache<Weight>::Tree>
+ShortestPathTreeCache<Weight>::GetTree(const DirectedWeightedGraph<Weight>& graph, VertexId root) {
+    {
+        std::lock_guard guard(mutex_);
+        if (auto it = root_to_tree_.find(root); it != root_to_tree_.end()) {
+            ++hits_;
+            trees_.splice(trees_.begin(), trees_, it->second);
+            return *it->second;
+        }
+        ++misses_;
+        if (Tree::ComputeByteSize(graph.GetVertexCount()) > max_bytes_) {
+            return nullptr;
+        }
+    }
+
+    // Дерево строится без блокировки, другие потоки могут пользоваться кэшем
+    auto tree = std::make_shared<const Tree>(graph, root);
+
+    std::lock_guard guard(mutex_);
+    if (root_to_tree_.count(root) == 0) {
+        byte_size_ += tree->GetByteSize();
+        trees_.push_front(tree);
+        root_to_tree_[root] = trees_.begin();
+        while (byte_size_ > max_bytes_) {
+            byte_size_ -= trees_.back()->GetByteSize();
+            root_to_tree_.erase(trees_.back()->GetRoot());
+            trees_.pop_back();
+        }
+    }
+    return tree;
+}
+
+template <typename Weight>
+void ShortestPathTreeCache<Weight>::Clear() {
+    std::lock_guard guard(mutex_);
+    trees_.clear();
+    root_to_tree_.clear();
+    byte_size_ = 0;
+}
+
+template <typename Weight>
+typename ShortestPathTreeCache<Weight>::Stats ShortestPathTreeCache<Weight>::GetStats() const {
+    std::lock_guard guard(mutex_);
+    return {hits_, misses_, trees_.size(), byte_size_};
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "graph.h"
+#include "router_base.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Поиск по упрощённой копии графа. Вершина, которая не может быть началом
+// или концом маршрута и имеет одно входящее или одно исходящее ребро, только
+// передаёт путь дальше: она удаляется, а каждая пара её входящего и исходящего
+// рёбер заменяется составным ребром с суммарным весом. Так же удаляются
+// тупиковые вершины без входящих или исходящих рёбер. Число рёбер при этом
+// не растёт, и удаление повторяется, пока такие вершины есть.
+// Составные рёбра в найденном пути раскрываются обратно в рёбра исходного графа.
+// Маршрутизатор для упрощённого графа создаётся функцией make_router,
+// она получает упрощённый граф и номера его вершин в исходном графе
+template <typename Weight>
+class SimplifiedGraphRouter : public RouterBase<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using typename RouterBase<Weight>::RouteInfo;
+    using VertexFilter = std::function<bool(VertexId vertex)>;
+    using RouterFactory = std::function<std::unique_ptr<RouterBase<Weight>>(
+        const Graph& graph, const std::vector<VertexId>& original_vertices)>;
+
+    // Вершины, для которых is_endpoint возвращает true, остаются в графе:
+    // только они могут быть началом и концом маршрута
+    SimplifiedGraphRouter(const Graph& graph, VertexFilter is_endpoint, RouterFactory make_router);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    std::vector<std::optional<Weight>> ComputeWeights(
+            VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Новые рёбра могут присоединиться к удалённым вершинам, граф упрощается заново
+    bool Update(EdgeId /*first_new_edge*/) override {
+        return false;
+    }
+
+    const Graph& GetSimplifiedGraph() const {
+        return simplified_graph_;
+    }
+
+private:
+    static constexpr VertexId NO_VERTEX = std::numeric_limits<VertexId>::max();
+
+    void Simplify();
+
+    // Номер вершины в упрощённом графе
+    VertexId ToSimplified(VertexId vertex) const;
+
+    // Добавить в edges рёбра исходного графа, которые заменяет ребро edge_id
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    const Graph& graph_;
+    VertexFilter is_endpoint_;
+    // Номера вершин в упрощённом графе, NO_VERTEX - вершина удалена
+    std::vector<VertexId> vertex_map_;
+    // Номера вершин упрощённого графа в исходном
+    std::vector<VertexId> original_vertices_;
+    Graph simplified_graph_;
+    // Для ребра упрощённого графа - номер ребра исходного графа,
+    // для составного ребра - GetEdgeCount() + номер в composite_parts_
+    std::vector<EdgeId> edge_origins_;
+    // Пары рёбер, которые заменяет составное ребро с номером GetEdgeCount() + i
+    std::vector<std::pair<EdgeId, EdgeId>> composite_parts_;
+    std::unique_ptr<RouterBase<Weight>> router_;
+};
+
+template <typename Weight>
+SimplifiedGraphRouter<Weight>::SimplifiedGraphRouter(const Graph& graph, VertexFilter is_endpoint,
+                                                     RouterFactory make_router)
+    : graph_(graph)
+    , is_endpoint_(std::move(is_endpoint))
+{
+    Simplify();
+    router_ = make_router(simplified_graph_, original_vertices_);
+}
+
+template <typename Weight>
+void SimplifiedGraphRouter<Weight>::Simplify() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t original_edge_count = graph_.GetEdgeCount();
+
+    // Рёбра исходного графа, за ними составные
+    std::vector<Edge<Weight>> edges;
+    edges.reserve(original_edge_count);
+    std::vector<bool> is_alive;
+    is_alive.reserve(original_edge_count);
+    std::vector<std::vector<EdgeId>> outgoing(vertex_count);
+    std::vector<std::vector<EdgeId>> incoming(vertex_count);
+    for (EdgeId edge_id = 0; edge_id < original_edge_count; ++edge_id) {
+        const Edge<Weight>& edge = graph_.GetEdge(edge_id);
+        if (edge.weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        edges.push_back(edge);
+        // Петля с неотрицательным весом не сокращает ни один путь
+        is_alive.push_back(edge.from != edge.to);
+        if (is_alive.back()) {
+            outgoing[edge.from].push_back(edge_id);
+            incoming[edge.to].push_back(edge_id);
+        }
+    }
+
+    // Удалённые рёбра вычёркиваются из списков смежности при просмотре вершины
+    const auto remove_dead_edges = [&is_alive](std::vector<EdgeId>& list) {
+        list.erase(std::remove_if(list.begin(), list.end(),
+                                  [&is_alive](EdgeId edge_id) {
+                                      return !is_alive[edge_id];
+                                  }),
+                   list.end());
+    };
+
+    std::vector<bool> is_removed(vertex_count, false);
+    std::vector<VertexId> candidates;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (!is_endpoint_(vertex)) {
+            candidates.push_back(vertex);
+        }
+    }
+    while (!candidates.empty()) {
+        const VertexId vertex = candidates.back();
+        candidates.pop_back();
+        if (is_removed[vertex]) {
+            continue;
+        }
+        std::vector<EdgeId>& in_edges = incoming[vertex];
+        std::vector<EdgeId>& out_edges = outgoing[vertex];
+        remove_dead_edges(in_edges);
+        remove_dead_edges(out_edges);
+        if (in_edges.size() > 1 && out_edges.size() > 1) {
+            continue;
+        }
+
+        is_removed[vertex] = true;
+        for (const EdgeId in_edge_id : in_edges) {
+            for (const EdgeId out_edge_id : out_edges) {
+                const VertexId from = edges[in_edge_id].from;
+                const VertexId to = edges[out_edge_id].to;
+                if (from == to) {
+                    continue;
+                }
+                const EdgeId edge_id = edges.size();
+                edges.push_back({from, to, edges[in_edge_id].weight + edges[out_edge_id].weight});
+                is_alive.push_back(true);
+                composite_parts_.push_back({in_edge_id, out_edge_id});
+                outgoing[from].push_back(edge_id);
+                incoming[to].push_back(edge_id);
+            }
+        }
+        // У соседей стало меньше рёбер, их можно попробовать удалить снова
+        for (const EdgeId edge_id : in_edges) {
+            is_alive[edge_id] = false;
+            if (!is_endpoint_(edges[edge_id].from)) {
+                candidates.push_back(edges[edge_id].from);
+            }
+        }
+        for (const EdgeId edge_id : out_edges) {
+            is_alive[edge_id] = false;
+            if (!is_endpoint_(edges[edge_id].to)) {
+                candidates.push_back(edges[edge_id].to);
+            }
+        }
+        in_edges.clear();
+        out_edges.clear();
+    }
+
+    vertex_map_.assign(vertex_count, NO_VERTEX);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (!is_removed[vertex]) {
+            vertex_map_[vertex] = simplified_graph_.AddVertex();
+            original_vertices_.push_back(vertex);
+        }
+    }
+    for (EdgeId edge_id = 0; edge_id < edges.size(); ++edge_id) {
+        if (is_alive[edge_id]) {
+            const Edge<Weight>& edge = edges[edge_id];
+            simplified_graph_.AddEdge({vertex_map_[edge.from], vertex_map_[edge.to], edge.weight});
+            edge_origins_.push_back(edge_id);
+        }
+    }
+    simplified_graph_.Freeze();
+}
+
+template <typename Weight>
+VertexId SimplifiedGraphRouter<Weight>::ToSimplified(VertexId vertex) const {
+    if (vertex >= vertex_map_.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (vertex_map_[vertex] == NO_VERTEX) {
+        throw std::invalid_argument("Vertex was removed by graph simplification");
+    }
+    return vertex_map_[vertex];
+}
+
+template <typename Weight>
+void SimplifiedGraphRouter<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    const size_t original_edge_count = graph_.GetEdgeCount();
+    std::vector<EdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const EdgeId current = stack.back();
+        stack.pop_back();
+        if (current < original_edge_count) {
+            edges.push_back(current);
+        } else {
+            const auto& [first, second] = composite_parts_[current - original_edge_count];
+            stack.push_back(second);
+            stack.push_back(first);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename SimplifiedGraphRouter<Weight>::RouteInfo>
+SimplifiedGraphRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    auto route = router_->BuildRoute(ToSimplified(from), ToSimplified(to));
+    if (!route) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge_id : route->edges) {
+        UnpackEdge(edge_origins_[edge_id], edges);
+    }
+    return RouteInfo{route->weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> SimplifiedGraphRouter<Weight>::ComputeWeights(
+        VertexId from, const std::vector<VertexId>& targets) const {
+    std::vector<VertexId> simplified_targets;
+    simplified_targets.reserve(targets.size());
+    for (const VertexId to : targets) {
+        simplified_targets.push_back(ToSimplified(to));
+    }
+    return router_->ComputeWeights(ToSimplified(from), simplified_targets);
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -85,6 +85,10 @@ size_t TransportCatalogue::GetStopCount() const {
     return stops_.size();
 }
 
+size_t TransportCatalogue::GetBusCount() const {
+    return buses_.size();
+}
+
 double TransportCatalogue::CalculateGeoRouteLength(const Bus* bus) const {
     if (bus->stops.size() < 2) {
         return 0.0;
@@ -1,12 +1,133 @@
+#include "alt_router.h"
+#include "alternative_routes.h"
+#include "astar_router.h"
+#include "bidirectional_router.h"
+#include "blocked_floyd_router.h"
+#include "ch_router.h"
+#include "compact_router.h"
+#include "dijkstra_router.h"
+#include "fixed_point_router.h"
+#include "hub_label_router.h"
+#include "mapped_file.h"
+#include "router.h"
+#include "simplified_router.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <limits>
+#include <optional>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 
 using namespace std::literals;
 
 namespace trouter {
 
+namespace {
+
+using CompactRouter = graph::CompactRouter<double>;
+using HubLabelRouter = graph::HubLabelRouter<double>;
+
+// Вес ребра в режиме fixed_point_weights - целое число миллисекунд
+using FixedWeight = uint32_t;
+constexpr double FIXED_POINT_UNITS_PER_MINUTE = 60000.0;
+
+// Заголовок файла с таблицей маршрутов. За ним следует vertex_count^2
+// элементов CompactRouter::RouteInternalData или, для файла меток,
+// 2 * vertex_count + 1 смещений uint64_t и элементы меток HubLabelRouter::LabelEntry
+struct RoutesCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t cell_size;
+    uint64_t graph_hash;
+    uint64_t vertex_count;
+};
+
+constexpr char ROUTES_CACHE_MAGIC[8] = {'T', 'C', 'R', 'O', 'U', 'T', 'E', 'S'};
+constexpr char HUB_LABELS_CACHE_MAGIC[8] = {'T', 'C', 'H', 'U', 'B', 'L', 'B', 'L'};
+constexpr uint32_t ROUTES_CACHE_VERSION = 1;
+
+RoutesCacheHeader MakeCacheHeader(const char (&magic)[8], uint32_t cell_size,
+                                  uint64_t graph_hash, uint64_t vertex_count) {
+    RoutesCacheHeader header{};
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = ROUTES_CACHE_VERSION;
+    header.cell_size = cell_size;
+    header.graph_hash = graph_hash;
+    header.vertex_count = vertex_count;
+    return header;
+}
+
+// Заголовок отображённого файла совпадает с ожидаемым
+bool IsCacheHeaderValid(const io::MappedFile& file, const RoutesCacheHeader& expected) {
+    if (file.GetSize() < sizeof(expected)) {
+        return false;
+    }
+    RoutesCacheHeader header;
+    std::memcpy(&header, file.GetData(), sizeof(header));
+    return std::memcmp(header.magic, expected.magic, sizeof(header.magic)) == 0
+        && header.version == expected.version
+        && header.cell_size == expected.cell_size
+        && header.graph_hash == expected.graph_hash
+        && header.vertex_count == expected.vertex_count;
+}
+
+// Записать заголовок и блоки данных во временный файл и переименовать,
+// чтобы другие процессы не отобразили в память недописанный файл.
+// При ошибке временный файл удаляется
+void WriteCacheFile(const std::string& path, const RoutesCacheHeader& header,
+                    std::initializer_list<std::pair<const void*, size_t>> blocks) {
+    const std::string temp_path = path + ".tmp"s;
+    bool is_written = false;
+    {
+        std::ofstream output(temp_path, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& [data, size] : blocks) {
+            output.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        }
+        output.close();
+        is_written = static_cast<bool>(output);
+    }
+    if (!is_written) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Can't write routes cache file "s + temp_path);
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Can't write routes cache file "s + path);
+    }
+}
+
+// Хеш FNV-1a
+class Fnv1aHasher {
+public:
+    template <typename T>
+    void Add(const T& value) {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            hash_ = (hash_ ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+
+    uint64_t GetHash() const {
+        return hash_;
+    }
+
+private:
+    uint64_t hash_ = 14695981039346656037ULL;
+};
+
+}  // namespace
+
 void TransportRouter::SetRoutingSettings(const RoutingSettings& settings) {
     if (settings.bus_velocity <= 0.0) {
         throw std::runtime_error("Incorrect bus velocity"s);
@@ -14,6 +135,12 @@ void TransportRouter::SetRoutingSettings(const RoutingSettings& settings) {
     if (settings.bus_wait_time < 0.0) {
         throw std::runtime_error("Incorrect bus wait time"s);
     }
+    if (settings.heuristic_factor < 0.0) {
+        throw std::runtime_error("Incorrect heuristic factor"s);
+    }
+    if (settings.landmark_count == 0) {
+        throw std::runtime_error("Incorrect landmark count"s);
+    }
     settings_ = settings;
 }
 
@@ -22,97 +149,842 @@ std::optional<RouteInfo> TransportRouter::BuildRoute(const tcat::Stop* from,
     if (!IsRouterInitialized()) {
         throw std::runtime_error("Router is not initialized"s);
     }
-    graph::VertexId start_vertex_of_from = stop_ptr_to_vertex_id_.at(from);
-    graph::VertexId start_vertex_of_to = stop_ptr_to_vertex_id_.at(to);
+    if (settings_.router_type == RouterType::RAPTOR) {
+        if (auto journey = raptor_ptr_->BuildRoute(from, to)) {
+            return MakeRouteInfo(*journey);
+        }
+        return std::nullopt;
+    }
+    if (auto route_info = BuildGraphRoute(stop_ptr_to_vertex_id_.at(from),
+                                          stop_ptr_to_vertex_id_.at(to))) {
+        return MakeRouteInfo(*route_info);
+    } else {
+        return std::nullopt;
+    }
+}
+
+std::optional<graph::RouterBase<double>::RouteInfo> TransportRouter::BuildGraphRoute(
+        graph::VertexId from, graph::VertexId to) const {
+    if (!IsReachable(from, to)) {
+        return std::nullopt;
+    }
+    std::shared_ptr<const graph::ShortestPathTree<double>> tree;
+    if (tree_cache_ptr_) {
+        tree = tree_cache_ptr_->GetTree(*graph_ptr_, from);
+    }
+    if (tree) {
+        return tree->BuildRoute(*graph_ptr_, to);
+    }
+    return router_ptr_->BuildRoute(from, to);
+}
+
+std::vector<std::optional<RouteInfo>> TransportRouter::BuildRoutes(
+        const std::vector<StopPair>& requests) const {
+    if (!IsRouterInitialized()) {
+        throw std::runtime_error("Router is not initialized"s);
+    }
+    std::vector<std::optional<RouteInfo>> result(requests.size());
+    if (!CanShareShortestPathTree()) {
+        for (size_t i = 0; i < requests.size(); ++i) {
+            result[i] = BuildRoute(requests[i].first, requests[i].second);
+        }
+        return result;
+    }
 
-    auto route_info = router_ptr_->BuildRoute(start_vertex_of_from, start_vertex_of_to);
+    // Номера запросов для каждой начальной остановки
+    std::unordered_map<const tcat::Stop*, std::vector<size_t>> requests_by_origin;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const auto& [from, to] = requests[i];
+        // Дерево не строится для начальной остановки, из которой
+        // не доехать ни до одной из конечных
+        if (IsReachable(stop_ptr_to_vertex_id_.at(from), stop_ptr_to_vertex_id_.at(to))) {
+            requests_by_origin[from].push_back(i);
+        }
+    }
+    for (const auto& [from, indexes] : requests_by_origin) {
+        if (indexes.size() == 1) {
+            result[indexes.front()] = BuildRoute(from, requests[indexes.front()].second);
+            continue;
+        }
+        const graph::VertexId from_vertex = stop_ptr_to_vertex_id_.at(from);
+        std::shared_ptr<const graph::ShortestPathTree<double>> tree;
+        if (tree_cache_ptr_) {
+            tree = tree_cache_ptr_->GetTree(*graph_ptr_, from_vertex);
+        }
+        if (!tree) {
+            tree = std::make_shared<graph::ShortestPathTree<double>>(*graph_ptr_, from_vertex);
+        }
+        for (const size_t i : indexes) {
+            if (auto route_info = tree->BuildRoute(*graph_ptr_,
+                                                   stop_ptr_to_vertex_id_.at(requests[i].second))) {
+                result[i] = MakeRouteInfo(*route_info);
+            }
+        }
+    }
+    return result;
+}
 
-    if (route_info) {
-        RouteInfo result;
-        result.total_time = route_info->weight;
-        for (graph::EdgeId edge_id : route_info->edges) {
-            const EdgeData& data = edge_id_to_data.at(edge_id);
-            if (data.span_count == 0) {
+std::vector<RouteInfo> TransportRouter::BuildAlternativeRoutes(const tcat::Stop* from,
+        const tcat::Stop* to, size_t route_count) const {
+    if (!IsRouterInitialized()) {
+        throw std::runtime_error("Router is not initialized"s);
+    }
+    if (settings_.router_type == RouterType::RAPTOR) {
+        // Без графа альтернативы не ищутся
+        throw std::runtime_error("Incorrect request: alternatives are not supported by raptor router"s);
+    }
+    std::vector<RouteInfo> result;
+    const graph::VertexId from_vertex = stop_ptr_to_vertex_id_.at(from);
+    const graph::VertexId to_vertex = stop_ptr_to_vertex_id_.at(to);
+    // Первый маршрут - тот же, что в ответе на запрос Route без alternatives
+    auto first_route = BuildGraphRoute(from_vertex, to_vertex);
+    if (!first_route) {
+        return result;
+    }
+    graph::AlternativeRoutesFinder<double> finder(*graph_ptr_);
+    for (const auto& route_info : finder.BuildRoutes(from_vertex, to_vertex, route_count,
+                                                     std::move(*first_route))) {
+        result.push_back(MakeRouteInfo(route_info));
+    }
+    return result;
+}
+
+std::vector<RouteInfo> TransportRouter::BuildTransferOptions(const tcat::Stop* from,
+        const tcat::Stop* to) const {
+    if (!IsRouterInitialized()) {
+        throw std::runtime_error("Router is not initialized"s);
+    }
+    std::vector<RouteInfo> result;
+    for (const auto& journey : GetRaptorRouter().BuildTransferOptions(from, to)) {
+        result.push_back(MakeRouteInfo(journey));
+    }
+    return result;
+}
+
+RouteInfo TransportRouter::MakeRouteInfo(const RaptorRouter::Journey& journey) const {
+    RouteInfo result;
+    result.total_time = journey.total_time;
+    for (const auto& leg : journey.legs) {
+        result.parts.emplace_back(WaitItem{leg.stop->name, settings_.bus_wait_time});
+        result.parts.emplace_back(BusItem{leg.bus_name, leg.span_count, leg.time});
+    }
+    return result;
+}
+
+RouteInfo TransportRouter::MakeRouteInfo(const graph::RouterBase<double>::RouteInfo& route_info) const {
+    RouteInfo result;
+    result.total_time = route_info.weight;
+    for (graph::EdgeId edge_id : route_info.edges) {
+        const EdgeData& data = edge_data_[edge_id];
+        const double time = graph_ptr_->GetEdgeUnchecked(edge_id).weight;
+        switch (data.type) {
+            case EdgeType::WAIT: {
                 WaitItem item;
-                item.stop_name = data.name;
-                item.time = data.time;
+                item.stop_name = names_[data.name_id];
+                item.time = time;
                 result.parts.emplace_back(item);
-            } else {
+                break;
+            }
+            case EdgeType::BUS:
+            case EdgeType::BOARD: {
                 BusItem item;
-                item.bus_name = data.name;
+                item.bus_name = names_[data.name_id];
                 item.span_count = data.span_count;
-                item.time = data.time;
+                item.time = time;
                 result.parts.emplace_back(item);
+                break;
+            }
+            case EdgeType::RIDE: {
+                // Проезд продолжает поездку, начатую посадкой
+                BusItem& item = std::get<BusItem>(result.parts.back());
+                item.span_count += data.span_count;
+                item.time += time;
+                break;
             }
+            case EdgeType::ALIGHT:
+                break;
+        }
+    }
+    return result;
+}
+
+TransportRouter::RouteMatrix TransportRouter::BuildRouteMatrix(
+        const std::vector<const tcat::Stop*>& from, const std::vector<const tcat::Stop*>& to) const {
+    if (!IsRouterInitialized()) {
+        throw std::runtime_error("Router is not initialized"s);
+    }
+    const bool is_raptor = settings_.router_type == RouterType::RAPTOR;
+    // Известные остановки to и их позиции в строке матрицы
+    std::vector<const tcat::Stop*> target_stops;
+    std::vector<graph::VertexId> target_vertices;
+    std::vector<size_t> target_columns;
+    for (size_t column = 0; column < to.size(); ++column) {
+        if (to[column]) {
+            target_stops.push_back(to[column]);
+            if (!is_raptor) {
+                target_vertices.push_back(stop_ptr_to_vertex_id_.at(to[column]));
+            }
+            target_columns.push_back(column);
+        }
+    }
+
+    // Повторяющиеся остановки from считаются один раз
+    RouteMatrix result(from.size(), std::vector<std::optional<double>>(to.size()));
+    std::unordered_map<const tcat::Stop*, size_t> computed_rows;
+    for (size_t row = 0; row < from.size(); ++row) {
+        if (!from[row]) {
+            continue;
+        }
+        if (auto it = computed_rows.find(from[row]); it != computed_rows.end()) {
+            result[row] = result[it->second];
+            continue;
+        }
+        computed_rows.emplace(from[row], row);
+        if (is_raptor) {
+            auto times = raptor_ptr_->ComputeTimes(from[row], target_stops);
+            for (size_t i = 0; i < times.size(); ++i) {
+                result[row][target_columns[i]] = times[i];
+            }
+            continue;
+        }
+        // Поиск до недостижимой вершины просматривает весь граф,
+        // поэтому такие вершины исключаются заранее
+        const graph::VertexId from_vertex = stop_ptr_to_vertex_id_.at(from[row]);
+        std::vector<graph::VertexId> reachable_vertices;
+        std::vector<size_t> reachable_columns;
+        for (size_t i = 0; i < target_vertices.size(); ++i) {
+            if (IsReachable(from_vertex, target_vertices[i])) {
+                reachable_vertices.push_back(target_vertices[i]);
+                reachable_columns.push_back(target_columns[i]);
+            }
+        }
+        if (reachable_vertices.empty()) {
+            continue;
+        }
+        auto weights = router_ptr_->ComputeWeights(from_vertex, reachable_vertices);
+        for (size_t i = 0; i < weights.size(); ++i) {
+            result[row][reachable_columns[i]] = weights[i];
+        }
+    }
+    return result;
+}
+
+std::vector<IsochroneItem> TransportRouter::BuildIsochrone(const tcat::Stop* from,
+        double max_time, IsochroneOrder order) const {
+    if (!IsRouterInitialized()) {
+        throw std::runtime_error("Router is not initialized"s);
+    }
+    std::vector<IsochroneItem> result;
+    if (settings_.router_type == RouterType::RAPTOR) {
+        for (const auto& [stop, time] : raptor_ptr_->FindReachableStops(from, max_time)) {
+            result.push_back({stop->name, time});
         }
-        return result;
     } else {
-        return std::nullopt;
+        // Время до остановки - время прибытия в вершину начала ожидания
+        for (const auto& [vertex, time] : graph::FindReachableVertices(
+                 *graph_ptr_, stop_ptr_to_vertex_id_.at(from), max_time)) {
+            if (is_wait_start_vertex_[vertex]) {
+                result.push_back({vertex_id_to_stop_[vertex]->name, time});
+            }
+        }
+    }
+    if (order == IsochroneOrder::BY_NAME) {
+        std::sort(result.begin(), result.end(),
+            [](const IsochroneItem& lhs, const IsochroneItem& rhs) {
+                return lhs.stop_name < rhs.stop_name;
+            });
     }
+    return result;
+}
+
+const RaptorRouter& TransportRouter::GetRaptorRouter() const {
+    std::lock_guard guard(raptor_mutex_);
+    if (!raptor_ptr_) {
+        raptor_ptr_ = std::make_unique<RaptorRouter>(settings_.bus_wait_time,
+                                                     settings_.bus_velocity);
+        raptor_ptr_->Update(*db_);
+    }
+    return *raptor_ptr_;
 }
 
 void TransportRouter::InitRouter(const tcat::TransportCatalogue& db) {
+    graph_ptr_.reset();
+    router_ptr_.reset();
+    reachability_ptr_.reset();
+    stop_ptr_to_vertex_id_.clear();
+    vertex_id_to_stop_.clear();
+    is_wait_start_vertex_.clear();
+    edge_data_.clear();
+    names_.clear();
+    name_to_id_.clear();
+    routed_stop_count_ = 0;
+    routed_bus_count_ = 0;
+    tree_cache_ptr_.reset();
+    raptor_ptr_.reset();
+    db_ = &db;
+
+    if (settings_.router_type == RouterType::RAPTOR) {
+        GetRaptorRouter();
+        routed_stop_count_ = db.GetStopCount();
+        routed_bus_count_ = db.GetBusCount();
+        return;
+    }
+    // Дерево строится по исходному графу поиском Дейкстры, поэтому кэш
+    // не заменяет таблицы, иерархии и метки, построенные заранее
+    if (settings_.tree_cache_bytes > 0 && IsPerQuerySearch()) {
+        tree_cache_ptr_ = std::make_unique<graph::ShortestPathTreeCache<double>>(
+            settings_.tree_cache_bytes);
+    }
+
+    graph_ptr_ = std::make_unique<graph::DirectedWeightedGraph<double>>();
+    AddNewStopsAndBuses(db);
+
+    graph_ptr_->Freeze();
+    if (NeedsReachabilityIndex()) {
+        reachability_ptr_ = std::make_unique<graph::ReachabilityIndex<double>>(*graph_ptr_);
+    }
+    CreateRouter();
+}
+
+void TransportRouter::UpdateRouter(const tcat::TransportCatalogue& db) {
+    if (!IsRouterInitialized()) {
+        throw std::runtime_error("Router is not initialized"s);
+    }
+    if (db.GetStopCount() == routed_stop_count_ && db.GetBusCount() == routed_bus_count_) {
+        return;
+    }
+    db_ = &db;
+    if (raptor_ptr_) {
+        raptor_ptr_->Update(db);
+    }
+    if (settings_.router_type == RouterType::RAPTOR) {
+        routed_stop_count_ = db.GetStopCount();
+        routed_bus_count_ = db.GetBusCount();
+        return;
+    }
+
+    graph_ptr_->Unfreeze();
+    const graph::EdgeId first_new_edge = graph_ptr_->GetEdgeCount();
+    AddNewStopsAndBuses(db);
+    graph_ptr_->Freeze();
+    if (NeedsReachabilityIndex()) {
+        reachability_ptr_ = std::make_unique<graph::ReachabilityIndex<double>>(*graph_ptr_);
+    }
+
+    if (!router_ptr_->Update(first_new_edge)) {
+        CreateRouter();
+    }
+    if (tree_cache_ptr_) {
+        tree_cache_ptr_->Clear();
+    }
+}
+
+void TransportRouter::AddNewStopsAndBuses(const tcat::TransportCatalogue& db) {
+    // Справочник возвращает остановки и автобусы в порядке добавления,
+    // поэтому новые находятся в конце
     std::vector<const tcat::Stop*> stops = db.GetAllStops();
+    for (size_t i = routed_stop_count_; i < stops.size(); ++i) {
+        AddStop(stops[i]);
+    }
+    routed_stop_count_ = stops.size();
 
-    // Вершин графа в 2 раза больше чем остановок
-    // Чётные вершины -> начало ожидания автобуса
-    // Нечётные вершины -> конец ожидания автобуса
-    size_t vertex_count = stops.size() * 2;
-    graph_ptr_ = std::make_unique<graph::DirectedWeightedGraph<double>>(vertex_count);
-
-    for(size_t i = 0; i < stops.size(); ++i) {
-        // Сформировать словарь для поиска вершин остановок
-        const tcat::Stop* stop = stops[i];
-        stop_ptr_to_vertex_id_[stop] = i * 2;
-
-        // Добавить рёбра ожидания автобуса на остановке
-        graph::VertexId start_vertex = i * 2;
-        graph::VertexId end_vertex = i * 2 + 1;
-        graph::Edge<double> edge{start_vertex, end_vertex, settings_.bus_wait_time};
-        graph::EdgeId edge_id = graph_ptr_->AddEdge(edge);
-        edge_id_to_data.emplace(edge_id, EdgeData{0, stop->name, settings_.bus_wait_time});
-    }
-    
     std::vector<const tcat::Bus*> buses = db.GetAllBuses();
-    for (const tcat::Bus* bus : buses) {
-        // Если маршрут не кольцевой, сделать его кольцевым для упрощения расчётов
-        std::vector<const tcat::Stop*> rounded_stops = bus->stops;
-        if (!bus->is_roundtrip) {
-            for (auto it = bus->stops.rbegin() + 1; it != bus->stops.rend(); ++it) {
-                rounded_stops.push_back(*it);
+    AddBuses(db, buses, routed_bus_count_);
+    routed_bus_count_ = buses.size();
+}
+
+graph::VertexId TransportRouter::AddVertex(const tcat::Stop* stop, bool is_wait_start) {
+    vertex_id_to_stop_.push_back(stop);
+    is_wait_start_vertex_.push_back(is_wait_start);
+    return graph_ptr_->AddVertex();
+}
+
+void TransportRouter::AddStop(const tcat::Stop* stop) {
+    // Каждой остановке соответствуют 2 вершины графа
+    // Первая вершина -> начало ожидания автобуса
+    // Вторая вершина -> конец ожидания автобуса
+    graph::VertexId start_vertex = AddVertex(stop, true);
+    graph::VertexId end_vertex = AddVertex(stop, false);
+    // Сформировать словарь для поиска вершин остановок
+    stop_ptr_to_vertex_id_[stop] = start_vertex;
+
+    // Добавить рёбро ожидания автобуса на остановке
+    graph::Edge<double> edge{start_vertex, end_vertex, settings_.bus_wait_time};
+    AddEdge(edge, EdgeData{EdgeType::WAIT, 0, InternName(stop->name)});
+}
+
+graph::EdgeId TransportRouter::AddEdge(const graph::Edge<double>& edge, const EdgeData& data) {
+    graph::EdgeId edge_id = graph_ptr_->AddEdge(edge);
+    edge_data_.push_back(data);
+    return edge_id;
+}
+
+uint32_t TransportRouter::InternName(std::string_view name) {
+    auto [it, inserted] = name_to_id_.emplace(name, static_cast<uint32_t>(names_.size()));
+    if (inserted) {
+        names_.push_back(name);
+    }
+    return it->second;
+}
+
+void TransportRouter::AddBuses(const tcat::TransportCatalogue& db,
+        const std::vector<const tcat::Bus*>& buses, size_t first_bus) {
+    const size_t bus_count = buses.size() - first_bus;
+    if (bus_count == 0) {
+        return;
+    }
+
+    // Названия и вершины проезда добавляются последовательно
+    std::vector<uint32_t> name_ids(bus_count);
+    std::vector<graph::VertexId> first_ride_vertices(bus_count);
+    for (size_t i = 0; i < bus_count; ++i) {
+        const tcat::Bus* bus = buses[first_bus + i];
+        name_ids[i] = InternName(bus->name);
+        if (settings_.graph_model == GraphModel::RIDE_VERTICES) {
+            // Вершины проезда идут подряд в порядке остановок маршрута
+            first_ride_vertices[i] = graph_ptr_->GetVertexCount();
+            for (const tcat::Stop* stop : bus->GetRoundedStops()) {
+                AddVertex(stop, false);
+            }
+        }
+    }
+
+    // Потоки разбирают автобусы по одному и только читают справочник и граф
+    std::vector<BusEdges> bus_edges(bus_count);
+    std::atomic<size_t> next_bus{0};
+    auto worker = [&] {
+        for (size_t i = next_bus++; i < bus_count; i = next_bus++) {
+            const tcat::Bus* bus = buses[first_bus + i];
+            switch (settings_.graph_model) {
+                case GraphModel::SPAN_EDGES:
+                    bus_edges[i] = BuildSpanEdges(db, bus, name_ids[i]);
+                    break;
+                case GraphModel::RIDE_VERTICES:
+                    bus_edges[i] = BuildRideEdges(db, bus, name_ids[i], first_ride_vertices[i]);
+                    break;
+            }
+        }
+    };
+    size_t thread_count = settings_.thread_count;
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count, bus_count);
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (!settings_.prune_parallel_edges) {
+        for (BusEdges& edges : bus_edges) {
+            for (size_t i = 0; i < edges.edges.size(); ++i) {
+                AddEdge(edges.edges[i], edges.data[i]);
+            }
+            edges = BusEdges{};
+        }
+        return;
+    }
+
+    BusEdges new_edges;
+    for (BusEdges& edges : bus_edges) {
+        new_edges.edges.insert(new_edges.edges.end(), edges.edges.begin(), edges.edges.end());
+        new_edges.data.insert(new_edges.data.end(), edges.data.begin(), edges.data.end());
+        edges = BusEdges{};
+    }
+    PruneParallelEdges(new_edges);
+    for (size_t i = 0; i < new_edges.edges.size(); ++i) {
+        AddEdge(new_edges.edges[i], new_edges.data[i]);
+    }
+}
+
+void TransportRouter::PruneParallelEdges(BusEdges& new_edges) const {
+    const size_t vertex_count = graph_ptr_->GetVertexCount();
+    const size_t edge_count = new_edges.edges.size();
+
+    // Номера новых рёбер, упорядоченные по начальной вершине, а для одной
+    // начальной вершины - в порядке добавления
+    std::vector<size_t> offsets(vertex_count + 1, 0);
+    for (const auto& edge : new_edges.edges) {
+        ++offsets[edge.from + 1];
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        offsets[vertex + 1] += offsets[vertex];
+    }
+    std::vector<size_t> edges_by_from(edge_count);
+    {
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < edge_count; ++i) {
+            edges_by_from[next[new_edges.edges[i].from]++] = i;
+        }
+    }
+
+    // Лучшее ребро из текущей вершины в каждую вершину. При равном весе
+    // остаётся ребро, добавленное раньше: ребро графа или новое ребро
+    // автобуса, идущего раньше в справочнике
+    constexpr size_t GRAPH_EDGE = std::numeric_limits<size_t>::max();
+    std::vector<std::optional<double>> best_weights(vertex_count);
+    std::vector<size_t> best_edges(vertex_count);
+    std::vector<graph::VertexId> reached;
+    std::vector<bool> is_kept(edge_count, false);
+    const auto relax = [&](graph::VertexId to, double weight, size_t edge) {
+        if (!best_weights[to]) {
+            reached.push_back(to);
+        } else if (!(weight < *best_weights[to])) {
+            return;
+        }
+        best_weights[to] = weight;
+        best_edges[to] = edge;
+    };
+    for (graph::VertexId from = 0; from < vertex_count; ++from) {
+        if (offsets[from] == offsets[from + 1]) {
+            continue;
+        }
+        for (const graph::EdgeId edge_id : graph_ptr_->GetIncidentEdges(from)) {
+            const auto& edge = graph_ptr_->GetEdgeUnchecked(edge_id);
+            relax(edge.to, edge.weight, GRAPH_EDGE);
+        }
+        for (size_t i = offsets[from]; i < offsets[from + 1]; ++i) {
+            const auto& edge = new_edges.edges[edges_by_from[i]];
+            relax(edge.to, edge.weight, edges_by_from[i]);
+        }
+        for (const graph::VertexId to : reached) {
+            if (best_edges[to] != GRAPH_EDGE) {
+                is_kept[best_edges[to]] = true;
             }
+            best_weights[to].reset();
         }
+        reached.clear();
+    }
 
-        for (size_t from = 0; from < rounded_stops.size() - 1; ++from) {
-            int distance = 0;
-            for (size_t to = from + 1; to < rounded_stops.size(); ++to) {
-                if (rounded_stops[from] == rounded_stops[to]) {
-                    continue;
+    size_t kept_count = 0;
+    for (size_t i = 0; i < edge_count; ++i) {
+        if (is_kept[i]) {
+            new_edges.edges[kept_count] = new_edges.edges[i];
+            new_edges.data[kept_count] = new_edges.data[i];
+            ++kept_count;
+        }
+    }
+    new_edges.edges.resize(kept_count);
+    new_edges.data.resize(kept_count);
+}
+
+TransportRouter::BusEdges TransportRouter::BuildSpanEdges(const tcat::TransportCatalogue& db,
+        const tcat::Bus* bus, uint32_t name_id) const {
+    std::vector<const tcat::Stop*> rounded_stops = bus->GetRoundedStops();
+    const size_t stop_count = rounded_stops.size();
+
+    // Вершины остановок и длины промежутков маршрута находятся один раз,
+    // а не для каждой пары остановок. segment_distances[i] - расстояние
+    // от остановки i - 1 до остановки i
+    std::vector<graph::VertexId> stop_vertices(stop_count);
+    std::vector<int> segment_distances(stop_count, 0);
+    for (size_t i = 0; i < stop_count; ++i) {
+        stop_vertices[i] = stop_ptr_to_vertex_id_.at(rounded_stops[i]);
+        if (i > 0) {
+            segment_distances[i] = db.GetDistance(rounded_stops[i - 1], rounded_stops[i]);
+        }
+    }
+
+    BusEdges result;
+    for (size_t from = 0; from + 1 < stop_count; ++from) {
+        graph::VertexId end_vertex_of_from = stop_vertices[from] + 1;
+        int distance = 0;
+        for (size_t to = from + 1; to < stop_count; ++to) {
+            // Промежутки, которые заканчиваются на остановке from, не входят в расстояние
+            if (rounded_stops[from] == rounded_stops[to]) {
+                continue;
+            }
+
+            int span_count = static_cast<int>(to - from);
+
+            // Определить время поездки на автобусе
+            distance += segment_distances[to];
+            double weight = ComputeTravelTime(distance);
+
+            //Добавить рёбро поездки на автобус
+            graph::VertexId start_vertex_of_to = stop_vertices[to];
+            result.edges.push_back({end_vertex_of_from, start_vertex_of_to, weight});
+            result.data.push_back(EdgeData{EdgeType::BUS, span_count, name_id});
+        }
+    }
+    return result;
+}
+
+TransportRouter::BusEdges TransportRouter::BuildRideEdges(const tcat::TransportCatalogue& db,
+        const tcat::Bus* bus, uint32_t name_id, graph::VertexId first_ride_vertex) const {
+    std::vector<const tcat::Stop*> rounded_stops = bus->GetRoundedStops();
+
+    BusEdges result;
+    for (size_t i = 0; i < rounded_stops.size(); ++i) {
+        const tcat::Stop* stop = rounded_stops[i];
+        const graph::VertexId ride_vertex = first_ride_vertex + i;
+        const graph::VertexId stop_vertex = stop_ptr_to_vertex_id_.at(stop);
+
+        // Посадка после ожидания и высадка к началу ожидания следующего автобуса
+        result.edges.push_back({stop_vertex + 1, ride_vertex, 0.0});
+        result.data.push_back(EdgeData{EdgeType::BOARD, 0, name_id});
+        result.edges.push_back({ride_vertex, stop_vertex, 0.0});
+        result.data.push_back(EdgeData{EdgeType::ALIGHT, 0, name_id});
+
+        // Проезд до следующей остановки маршрута
+        if (i + 1 < rounded_stops.size()) {
+            double weight = ComputeTravelTime(db.GetDistance(stop, rounded_stops[i + 1]));
+            result.edges.push_back({ride_vertex, ride_vertex + 1, weight});
+            result.data.push_back(EdgeData{EdgeType::RIDE, 1, name_id});
+        }
+    }
+    return result;
+}
+
+void TransportRouter::CreateRouter() {
+    if (settings_.fixed_point_weights) {
+        router_ptr_ = std::make_unique<graph::FixedPointRouter<double, FixedWeight>>(
+            *graph_ptr_, FIXED_POINT_UNITS_PER_MINUTE,
+            [this](const graph::DirectedWeightedGraph<FixedWeight>& graph) {
+                return MakeRouter(graph);
+            });
+    } else {
+        router_ptr_ = MakeRouter(*graph_ptr_);
+    }
+}
+
+template <typename Weight>
+std::unique_ptr<graph::RouterBase<Weight>> TransportRouter::MakeRouter(
+        const graph::DirectedWeightedGraph<Weight>& graph) const {
+    if (!settings_.simplify_graph) {
+        return MakeGraphRouter(graph);
+    }
+    // Маршруты начинаются и заканчиваются только в вершинах начала ожидания
+    return std::make_unique<graph::SimplifiedGraphRouter<Weight>>(graph,
+        [this](graph::VertexId vertex) {
+            return static_cast<bool>(is_wait_start_vertex_[vertex]);
+        },
+        [this](const graph::DirectedWeightedGraph<Weight>& simplified_graph,
+               const std::vector<graph::VertexId>& original_vertices) {
+            return MakeGraphRouter(simplified_graph, &original_vertices);
+        });
+}
+
+template <typename Weight>
+std::unique_ptr<graph::RouterBase<Weight>> TransportRouter::MakeGraphRouter(
+        const graph::DirectedWeightedGraph<Weight>& graph,
+        const std::vector<graph::VertexId>* original_vertices) const {
+    switch (settings_.router_type) {
+        case RouterType::ALL_PAIRS:
+            return std::make_unique<graph::Router<Weight>>(graph);
+        case RouterType::ALL_PAIRS_PARALLEL:
+            return std::make_unique<graph::Router<Weight>>(graph, settings_.thread_count);
+        case RouterType::ALL_PAIRS_COMPACT:
+            if constexpr (std::is_same_v<Weight, double>) {
+                if (!settings_.cache_file.empty()) {
+                    return CreateCachedCompactRouter(graph);
+                }
+            }
+            return std::make_unique<graph::CompactRouter<Weight>>(graph);
+        case RouterType::ALL_PAIRS_BLOCKED:
+            return std::make_unique<graph::BlockedFloydRouter<Weight>>(graph,
+                                                                       settings_.thread_count);
+        case RouterType::DIJKSTRA:
+            return std::make_unique<graph::DijkstraRouter<Weight>>(graph);
+        case RouterType::BIDIRECTIONAL:
+            return std::make_unique<graph::BidirectionalDijkstraRouter<Weight>>(graph);
+        case RouterType::A_STAR:
+            return std::make_unique<graph::AStarRouter<Weight>>(graph,
+                [this, original_vertices](graph::VertexId from, graph::VertexId to) {
+                    if (original_vertices) {
+                        from = (*original_vertices)[from];
+                        to = (*original_vertices)[to];
+                    }
+                    if constexpr (std::is_integral_v<Weight>) {
+                        // Веса рёбер округлены вверх, оценка вниз, поэтому она остаётся нижней
+                        return static_cast<Weight>(std::floor(
+                            EstimateTravelTime(from, to) * FIXED_POINT_UNITS_PER_MINUTE));
+                    } else {
+                        return EstimateTravelTime(from, to);
+                    }
+                });
+        case RouterType::ALT:
+            return std::make_unique<graph::AltRouter<Weight>>(graph, settings_.landmark_count);
+        case RouterType::CONTRACTION_HIERARCHY:
+            return std::make_unique<graph::ContractionHierarchyRouter<Weight>>(graph);
+        case RouterType::HUB_LABELS:
+            if constexpr (std::is_same_v<Weight, double>) {
+                if (!settings_.cache_file.empty()) {
+                    return CreateCachedHubLabelRouter(graph);
                 }
+            }
+            return std::make_unique<graph::HubLabelRouter<Weight>>(graph);
+        case RouterType::RAPTOR:
+            break;
+    }
+    throw std::logic_error("Router type doesn't use graph"s);
+}
 
-                int span_count = static_cast<int>(to - from);
+std::unique_ptr<graph::RouterBase<double>> TransportRouter::CreateCachedCompactRouter(
+        const graph::DirectedWeightedGraph<double>& graph) const {
+    const std::string& path = settings_.cache_file;
+    const uint64_t vertex_count = graph.GetVertexCount();
+    const size_t table_size = vertex_count * vertex_count * sizeof(CompactRouter::RouteInternalData);
+    const RoutesCacheHeader header = MakeCacheHeader(ROUTES_CACHE_MAGIC,
+        sizeof(CompactRouter::RouteInternalData), ComputeGraphHash(graph), vertex_count);
 
-                // Определить время поездки на автобусе
-                distance += db.GetDistance(rounded_stops[to - 1], rounded_stops[to]);
-                constexpr double meter_per_km = 1000.0;
-                constexpr double minutes_in_hour = 60.0;
-                double weight = distance / meter_per_km / settings_.bus_velocity * minutes_in_hour;
+    // Файл, построенный для другого графа или другой версией программы,
+    // пересчитывается и перезаписывается
+    try {
+        auto file = std::make_shared<io::MappedFile>(path);
+        if (file->GetSize() == sizeof(header) + table_size && IsCacheHeaderValid(*file, header)) {
+            const auto* routes = reinterpret_cast<const CompactRouter::RouteInternalData*>(
+                file->GetData() + sizeof(header));
+            // Номера рёбер из повреждённой таблицы служат индексами без проверок
+            if (CompactRouter::IsTableValid(graph, routes)) {
+                return std::make_unique<CompactRouter>(graph, routes, std::move(file));
+            }
+        }
+    } catch (const std::runtime_error&) {
+        // Файла ещё нет
+    }
+
+    auto router = std::make_unique<CompactRouter>(graph);
+    try {
+        WriteCacheFile(path, header, {{router->GetRoutesData(), table_size}});
+    } catch (const std::runtime_error&) {
+        // Файл не записать, например, каталог только для чтения. Таблица
+        // уже построена в памяти, следующий запуск построит её заново
+    }
+    return router;
+}
+
+std::unique_ptr<graph::RouterBase<double>> TransportRouter::CreateCachedHubLabelRouter(
+        const graph::DirectedWeightedGraph<double>& graph) const {
+    const std::string& path = settings_.cache_file;
+    const uint64_t vertex_count = graph.GetVertexCount();
+    const size_t offset_count = 2 * vertex_count + 1;
+    const RoutesCacheHeader header = MakeCacheHeader(HUB_LABELS_CACHE_MAGIC,
+        sizeof(HubLabelRouter::LabelEntry), ComputeGraphHash(graph), vertex_count);
 
-                //Добавить рёбро поездки на автобус
-                graph::VertexId end_vertex_of_from = stop_ptr_to_vertex_id_.at(rounded_stops[from]) + 1;
-                graph::VertexId start_vertex_of_to = stop_ptr_to_vertex_id_.at(rounded_stops[to]);
-                graph::Edge<double> edge{end_vertex_of_from, start_vertex_of_to, weight};
-                graph::EdgeId edge_id = graph_ptr_->AddEdge(edge);
-                edge_id_to_data.emplace(edge_id, EdgeData{span_count, bus->name, weight});
+    try {
+        auto file = std::make_shared<io::MappedFile>(path);
+        const size_t entries_start = sizeof(header) + offset_count * sizeof(uint64_t);
+        if (file->GetSize() >= entries_start
+            && (file->GetSize() - entries_start) % sizeof(HubLabelRouter::LabelEntry) == 0
+            && IsCacheHeaderValid(*file, header)) {
+            const auto* offsets = reinterpret_cast<const uint64_t*>(
+                file->GetData() + sizeof(header));
+            const auto* entries = reinterpret_cast<const HubLabelRouter::LabelEntry*>(
+                file->GetData() + entries_start);
+            const size_t entry_count =
+                (file->GetSize() - entries_start) / sizeof(HubLabelRouter::LabelEntry);
+            // Повреждённые метки не используются: номера хабов и рёбер из них
+            // служат индексами без проверок
+            if (HubLabelRouter::AreLabelsValid(graph, offsets, entries, entry_count)) {
+                return std::make_unique<HubLabelRouter>(graph, offsets, entries, std::move(file));
             }
         }
+    } catch (const std::runtime_error&) {
+        // Файла ещё нет
+    }
+
+    auto router = std::make_unique<HubLabelRouter>(graph);
+    try {
+        WriteCacheFile(path, header,
+                       {{router->GetOffsetsData(), offset_count * sizeof(uint64_t)},
+                        {router->GetEntriesData(),
+                         router->GetEntryCount() * sizeof(HubLabelRouter::LabelEntry)}});
+    } catch (const std::runtime_error&) {
+        // Метки уже построены в памяти, файл будет записан при следующем запуске
     }
+    return router;
+}
+
+uint64_t TransportRouter::ComputeGraphHash(const graph::DirectedWeightedGraph<double>& graph) {
+    Fnv1aHasher hasher;
+    hasher.Add(static_cast<uint64_t>(graph.GetVertexCount()));
+    const size_t edge_count = graph.GetEdgeCount();
+    hasher.Add(static_cast<uint64_t>(edge_count));
+    for (graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        hasher.Add(static_cast<uint64_t>(edge.from));
+        hasher.Add(static_cast<uint64_t>(edge.to));
+        hasher.Add(edge.weight);
+    }
+    return hasher.GetHash();
+}
+
+double TransportRouter::ComputeTravelTime(double distance) const {
+    constexpr double meter_per_km = 1000.0;
+    constexpr double minutes_in_hour = 60.0;
+    return distance / meter_per_km / settings_.bus_velocity * minutes_in_hour;
+}
+
+double TransportRouter::EstimateTravelTime(graph::VertexId from, graph::VertexId to) const {
+    const tcat::Stop* from_stop = vertex_id_to_stop_[from];
+    const tcat::Stop* to_stop = vertex_id_to_stop_[to];
+    if (from_stop == to_stop) {
+        return 0.0;
+    }
+    // Автобус едет не быстрее bus_velocity и не короче, чем по прямой.
+    // std::max отсекает NaN на почти совпадающих координатах
+    double distance = std::max(0.0, geo::ComputeDistance(from_stop->coordinates,
+                                                        to_stop->coordinates));
+    double estimate = ComputeTravelTime(distance) * settings_.heuristic_factor;
+    // Из вершины начала ожидания нельзя уехать, не дождавшись автобуса
+    if (is_wait_start_vertex_[from]) {
+        estimate += settings_.bus_wait_time;
+    }
+    return estimate;
+}
+
+bool TransportRouter::IsReachable(graph::VertexId from, graph::VertexId to) const {
+    return !reachability_ptr_ || reachability_ptr_->IsReachable(from, to);
+}
+
+bool TransportRouter::NeedsReachabilityIndex() const {
+    switch (settings_.router_type) {
+        case RouterType::DIJKSTRA:
+        case RouterType::BIDIRECTIONAL:
+        case RouterType::A_STAR:
+        case RouterType::ALT:
+        case RouterType::CONTRACTION_HIERARCHY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool TransportRouter::CanShareShortestPathTree() const {
+    // Дерево строится тем же поиском Дейкстры, что и у DIJKSTRA, и при равном
+    // весе выбирает те же пути. Остальные алгоритмы могут выбрать другой путь
+    // равного веса, а таблица или иерархия отвечают быстрее полного дерева
+    return tree_cache_ptr_ || (settings_.router_type == RouterType::DIJKSTRA && IsPerQuerySearch());
+}
+
+bool TransportRouter::IsPerQuerySearch() const {
+    if (settings_.fixed_point_weights || settings_.simplify_graph) {
+        return false;
+    }
+    switch (settings_.router_type) {
+        case RouterType::DIJKSTRA:
+        case RouterType::BIDIRECTIONAL:
+        case RouterType::A_STAR:
+        case RouterType::ALT:
+            return true;
+        default:
+            return false;
+    }
+}
 
-    router_ptr_ = std::make_unique<graph::Router<double>>(*graph_ptr_);
+TransportRouter::TreeCacheStats TransportRouter::GetTreeCacheStats() const {
+    return tree_cache_ptr_ ? tree_cache_ptr_->GetStats() : TreeCacheStats{};
 }
 
 bool TransportRouter::IsRouterInitialized() const {
-    return router_ptr_.get() != nullptr;
+    return router_ptr_.get() != nullptr
+        || (settings_.router_type == RouterType::RAPTOR && raptor_ptr_.get() != nullptr);
 }
 
 }
\ No newline at end of file
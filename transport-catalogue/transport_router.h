@@ -2,11 +2,18 @@
 
 #include "domain.h"
 #include "graph.h"
-#include "router.h"
+#include "raptor_router.h"
+#include "reachability.h"
+#include "router_base.h"
+#include "shortest_path_tree.h"
 
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -30,6 +37,13 @@ struct BusItem {
     double time = 0.0;
 };
 
+struct IsochroneItem {
+    // Название остановки
+    std::string_view stop_name;
+    // Время в пути до остановки, в минутах
+    double time = 0.0;
+};
+
 struct RouteInfo {
     using Item = std::variant<WaitItem, BusItem>;
     // Суммарное время, в минутах
@@ -40,35 +54,281 @@ struct RouteInfo {
 
 class TransportRouter {
 public:
+    enum class RouterType {
+        // Предварительный расчёт всех маршрутов (O(V^3) времени и O(V^2) памяти)
+        ALL_PAIRS,
+        // Та же таблица маршрутов, строки улучшаются в несколько потоков
+        ALL_PAIRS_PARALLEL,
+        // Предварительный расчёт всех маршрутов в компактной таблице (8 байт на пару вершин)
+        ALL_PAIRS_COMPACT,
+        // Предварительный расчёт всех маршрутов блочным алгоритмом Флойда-Уоршелла
+        // по плоским матрицам в несколько потоков
+        ALL_PAIRS_BLOCKED,
+        // Алгоритм Дейкстры на каждый запрос
+        DIJKSTRA,
+        // Двунаправленный алгоритм Дейкстры на каждый запрос
+        BIDIRECTIONAL,
+        // Алгоритм A* с оценкой по географическому расстоянию между остановками
+        A_STAR,
+        // Алгоритм A* с оценкой по расстояниям до опорных вершин (ALT)
+        ALT,
+        // Иерархия сжатий (Contraction Hierarchies)
+        CONTRACTION_HIERARCHY,
+        // Двухточечные метки (hub labeling): вес пути - слияние двух меток
+        HUB_LABELS,
+        // Алгоритм RAPTOR по спискам остановок автобусов, граф не строится
+        RAPTOR,
+    };
+
+    enum class GraphModel {
+        // Ребро для каждой пары остановок одного автобуса (O(N^2) рёбер на маршрут)
+        SPAN_EDGES,
+        // Вершина для каждой остановки маршрута, рёбра посадки, проезда
+        // до следующей остановки и высадки (O(N) рёбер на маршрут).
+        // Время маршрутов то же, что и с SPAN_EDGES, но из маршрутов равного
+        // времени может быть выбран другой
+        RIDE_VERTICES,
+    };
+
     struct RoutingSettings {
         // Время ожидания автобуса на остановке, в минутах
         double bus_wait_time = 0.0;
         // Скорость автобуса, в км/ч
         double bus_velocity = 1.0;
+        // Способ построения графа
+        GraphModel graph_model = GraphModel::SPAN_EDGES;
+        // Алгоритм поиска маршрута
+        RouterType router_type = RouterType::ALL_PAIRS;
+        // Множитель нижней оценки времени в пути для A*. Значение меньше 1
+        // нужно, если дорожные расстояния бывают короче географических
+        double heuristic_factor = 1.0;
+        // Число потоков для построения графа, ALL_PAIRS_PARALLEL и ALL_PAIRS_BLOCKED,
+        // 0 - по числу ядер процессора
+        size_t thread_count = 0;
+        // Число опорных вершин для ALT
+        size_t landmark_count = 8;
+        // Файл для сохранения таблицы маршрутов ALL_PAIRS_COMPACT или меток
+        // HUB_LABELS между запусками. Пустая строка - не сохранять
+        std::string cache_file;
+        // Предел памяти кэша деревьев кратчайших путей из недавно использованных
+        // начальных остановок, в байтах. 0 - кэш не используется. Кэш работает
+        // только с DIJKSTRA, BIDIRECTIONAL, A_STAR и ALT без fixed_point_weights
+        // и simplify_graph
+        size_t tree_cache_bytes = 0;
+        // Искать маршруты по целым весам рёбер в миллисекундах, округлённым
+        // вверх, вместо дробных минут. cache_file при этом не используется
+        bool fixed_point_weights = false;
+        // Удалить из графа вершины, через которые путь только проходит,
+        // заменив их рёбра составными
+        bool simplify_graph = false;
+        // Из параллельных рёбер автобусов между одними вершинами оставлять
+        // только ребро с наименьшим временем
+        bool prune_parallel_edges = false;
     };
 
+    using TreeCacheStats = graph::ShortestPathTreeCache<double>::Stats;
+
     void SetRoutingSettings(const RoutingSettings& settings);
 
     std::optional<RouteInfo> BuildRoute(const tcat::Stop* from, const tcat::Stop* to) const;
 
+    // Маршруты для пар остановок (from, to), результаты в том же порядке.
+    // Если маршрут по дереву кратчайших путей совпадает с ответом BuildRoute
+    // (CanShareShortestPathTree), пары группируются по from, и для начальной
+    // остановки с несколькими конечными строится одно дерево, по которому
+    // восстанавливаются все её маршруты
+    using StopPair = std::pair<const tcat::Stop*, const tcat::Stop*>;
+    std::vector<std::optional<RouteInfo>> BuildRoutes(const std::vector<StopPair>& requests) const;
+
+    // Не более route_count маршрутов без повторных проходов через вершины графа,
+    // в порядке возрастания времени. Первый из них - оптимальный.
+    // С RouterType::RAPTOR не поддерживается
+    std::vector<RouteInfo> BuildAlternativeRoutes(const tcat::Stop* from, const tcat::Stop* to,
+                                                  size_t route_count) const;
+
+    // Маршруты, оптимальные по времени и числу поездок на автобусах,
+    // в порядке возрастания числа поездок. Каждый следующий быстрее предыдущего
+    std::vector<RouteInfo> BuildTransferOptions(const tcat::Stop* from,
+                                                const tcat::Stop* to) const;
+
+    // Суммарное время маршрутов из каждой остановки from в каждую остановку to,
+    // в минутах. Отсутствующие остановки (nullptr) и маршруты - std::nullopt
+    using RouteMatrix = std::vector<std::vector<std::optional<double>>>;
+    RouteMatrix BuildRouteMatrix(const std::vector<const tcat::Stop*>& from,
+                                 const std::vector<const tcat::Stop*>& to) const;
+
+    enum class IsochroneOrder {
+        BY_TIME,
+        BY_NAME,
+    };
+
+    // Остановки, до которых можно доехать из from не более чем за max_time минут
+    std::vector<IsochroneItem> BuildIsochrone(const tcat::Stop* from, double max_time,
+                                              IsochroneOrder order) const;
+
     void InitRouter(const tcat::TransportCatalogue& db);
 
+    // Добавить в граф остановки и автобусы, появившиеся в справочнике после
+    // построения маршрутизатора, и обновить маршрутизатор. Изменение расстояний
+    // между уже добавленными остановками не учитывается
+    void UpdateRouter(const tcat::TransportCatalogue& db);
+
     bool IsRouterInitialized() const;
 
+    // Число попаданий и промахов кэша деревьев кратчайших путей
+    TreeCacheStats GetTreeCacheStats() const;
+
 private:
-    RoutingSettings settings_;
-    
+    enum class EdgeType : uint8_t {
+        // Ожидание автобуса на остановке
+        WAIT,
+        // Поездка на автобусе на span_count промежутков
+        BUS,
+        // Посадка в автобус, проезд одного промежутка и высадка (GraphModel::RIDE_VERTICES)
+        BOARD,
+        RIDE,
+        ALIGHT,
+    };
+
+    // Данные ребра графа. Время ребра равно его весу в графе
     struct EdgeData {
+        EdgeType type;
         int span_count; // 0 - остановка, 1... - промежутки пройденные на автобусе
-        std::string_view name; // название остановки или автобуса
-        double time;
+        uint32_t name_id; // номер названия остановки или автобуса в names_
     };
 
+    // Кратчайший путь по графу, как в ответе на запрос Route: по дереву
+    // из кэша, если оно есть, иначе маршрутизатором router_ptr_
+    std::optional<graph::RouterBase<double>::RouteInfo> BuildGraphRoute(graph::VertexId from,
+                                                                        graph::VertexId to) const;
+
+    // false - маршрута из вершины from в вершину to точно нет.
+    // Без индекса достижимости всегда true
+    bool IsReachable(graph::VertexId from, graph::VertexId to) const;
+
+    // Маршрутизатор ищет путь по графу на каждый запрос, и поиск до недостижимой
+    // вершины дорог. Таблицы и метки отвечают о таких парах сразу сами
+    bool NeedsReachabilityIndex() const;
+
+    // Маршрутизатор ищет путь заново на каждый запрос по графу graph_ptr_,
+    // без предварительного расчёта таблицы или иерархии, упрощения графа
+    // и перевода весов в целые
+    bool IsPerQuerySearch() const;
+
+    // Маршруты из одной начальной вершины можно восстановить по одному дереву
+    // кратчайших путей так же, как их построил бы BuildRoute: поиск Дейкстры
+    // на каждый запрос по graph_ptr_ или кэш деревьев
+    bool CanShareShortestPathTree() const;
+
+    // Время поездки на автобусе в минутах по расстоянию в метрах
+    double ComputeTravelTime(double distance) const;
+
+    // Нижняя оценка времени в пути между вершинами графа для A*
+    double EstimateTravelTime(graph::VertexId from, graph::VertexId to) const;
+
+    // Добавить в граф остановки и автобусы справочника, которых в нём ещё нет
+    void AddNewStopsAndBuses(const tcat::TransportCatalogue& db);
+
+    graph::VertexId AddVertex(const tcat::Stop* stop, bool is_wait_start);
+
+    graph::EdgeId AddEdge(const graph::Edge<double>& edge, const EdgeData& data);
+
+    // Номер названия в names_, новое название добавляется
+    uint32_t InternName(std::string_view name);
+
+    // Добавить вершины остановки и ребро ожидания автобуса
+    void AddStop(const tcat::Stop* stop);
+
+    // Рёбра одного автобуса и их данные. Строятся для каждого автобуса
+    // независимо и добавляются в граф в порядке автобусов
+    struct BusEdges {
+        std::vector<graph::Edge<double>> edges;
+        std::vector<EdgeData> data;
+    };
+
+    // Добавить в граф автобусы справочника начиная с first_bus. Рёбра
+    // автобусов строятся в нескольких потоках, номера рёбер не зависят
+    // от числа потоков
+    void AddBuses(const tcat::TransportCatalogue& db, const std::vector<const tcat::Bus*>& buses,
+                  size_t first_bus);
+
+    // Оставить из новых рёбер с одинаковыми началом и концом только ребро
+    // с наименьшим весом. Новое ребро не остаётся, если в графе уже есть
+    // ребро не тяжелее
+    void PruneParallelEdges(BusEdges& new_edges) const;
+
+    // Рёбра поездок на автобусе между каждой парой остановок маршрута
+    BusEdges BuildSpanEdges(const tcat::TransportCatalogue& db, const tcat::Bus* bus,
+                            uint32_t name_id) const;
+
+    // Рёбра посадки, проезда и высадки. Вершины проезда автобуса уже добавлены
+    // в граф подряд начиная с first_ride_vertex
+    BusEdges BuildRideEdges(const tcat::TransportCatalogue& db, const tcat::Bus* bus,
+                            uint32_t name_id, graph::VertexId first_ride_vertex) const;
+
+    // Преобразовать путь в графе в элементы маршрута
+    RouteInfo MakeRouteInfo(const graph::RouterBase<double>::RouteInfo& route_info) const;
+    RouteInfo MakeRouteInfo(const RaptorRouter::Journey& journey) const;
+
+    // Создать маршрутизатор по построенному графу
+    void CreateRouter();
+
+    // Маршрутизатор для графа с весами Weight, с упрощением графа,
+    // если оно включено настройкой simplify_graph
+    template <typename Weight>
+    std::unique_ptr<graph::RouterBase<Weight>> MakeRouter(
+            const graph::DirectedWeightedGraph<Weight>& graph) const;
+
+    // Маршрутизатор типа settings_.router_type для графа с весами Weight.
+    // original_vertices - номера вершин графа graph в графе graph_ptr_,
+    // nullptr - номера совпадают
+    template <typename Weight>
+    std::unique_ptr<graph::RouterBase<Weight>> MakeGraphRouter(
+            const graph::DirectedWeightedGraph<Weight>& graph,
+            const std::vector<graph::VertexId>* original_vertices = nullptr) const;
+
+    // Создать ALL_PAIRS_COMPACT маршрутизатор, используя файл с таблицей
+    // маршрутов, если он построен для такого же графа
+    std::unique_ptr<graph::RouterBase<double>> CreateCachedCompactRouter(
+            const graph::DirectedWeightedGraph<double>& graph) const;
+
+    // Создать HUB_LABELS маршрутизатор, используя файл с метками,
+    // если он построен для такого же графа
+    std::unique_ptr<graph::RouterBase<double>> CreateCachedHubLabelRouter(
+            const graph::DirectedWeightedGraph<double>& graph) const;
+
+    // RaptorRouter по справочнику db_, строится при первом обращении
+    const RaptorRouter& GetRaptorRouter() const;
+
+    // Хеш графа, по которому проверяется соответствие файла таблицы маршрутов
+    static uint64_t ComputeGraphHash(const graph::DirectedWeightedGraph<double>& graph);
+
+    RoutingSettings settings_;
+    
+    // Число остановок и автобусов справочника, уже добавленных в граф
+    size_t routed_stop_count_ = 0;
+    size_t routed_bus_count_ = 0;
     std::unordered_map<const tcat::Stop*, graph::VertexId> stop_ptr_to_vertex_id_;
-    std::unordered_map<graph::EdgeId, EdgeData> edge_id_to_data;
+    std::vector<const tcat::Stop*> vertex_id_to_stop_;
+    std::vector<bool> is_wait_start_vertex_;
+    // Данные рёбер по номерам рёбер графа
+    std::vector<EdgeData> edge_data_;
+    // Названия остановок и автобусов, на которые ссылаются рёбра
+    std::vector<std::string_view> names_;
+    std::unordered_map<std::string_view, uint32_t> name_to_id_;
 
     std::unique_ptr<graph::DirectedWeightedGraph<double>> graph_ptr_;
-    std::unique_ptr<graph::Router<double>> router_ptr_;
+    std::unique_ptr<graph::RouterBase<double>> router_ptr_;
+    std::unique_ptr<graph::ShortestPathTreeCache<double>> tree_cache_ptr_;
+    // Компоненты сильной связности графа, чтобы не искать заведомо
+    // отсутствующие маршруты. Строятся, только если NeedsReachabilityIndex()
+    std::unique_ptr<graph::ReachabilityIndex<double>> reachability_ptr_;
+    // Справочник, по которому строится RaptorRouter
+    const tcat::TransportCatalogue* db_ = nullptr;
+    // С RouterType::RAPTOR строится в InitRouter вместо графа,
+    // с другими router_type - при первом вызове BuildTransferOptions
+    mutable std::unique_ptr<RaptorRouter> raptor_ptr_;
+    mutable std::mutex raptor_mutex_;
 };
 
 }
\ No newline at end of file